@@ -0,0 +1,80 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_AFFINITY_HPP
+#define BOOST_MMM_AFFINITY_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/current_context.hpp>
+
+#include <boost/fusion/include/at.hpp>
+
+namespace boost { namespace mmm {
+
+namespace detail {
+
+struct kernel_placement
+{
+    std::size_t kernel;
+}; // struct kernel_placement
+
+} // namespace boost::mmm::detail
+
+/**
+ * <b>Returns</b>: A placement which pins spawned <i>user-thread</i> to
+ * <i>kernel-thread</i> of index k, to be passed as first argument of
+ * scheduler::add_thread. The index should be less than kernel_size().
+ */
+inline detail::kernel_placement
+on_kernel(std::size_t k) BOOST_MMM_NOEXCEPT
+{
+    const detail::kernel_placement p = { k };
+    return p;
+}
+
+namespace this_ctx {
+
+/**
+ * <b>Effects</b>: Pin current context to the <i>kernel-thread</i> running it,
+ * so that it is never resumed by others. No effects if current context is not
+ * controlled under scheduler.
+ *
+ * <b>Note</b>: If the <i>kernel-thread</i> is removed, pinned contexts on it
+ * are unpinned.
+ */
+inline void
+pin()
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        fusion::at_c<2>(*ctx_tuple).pinned = true;
+    }
+}
+
+/**
+ * <b>Effects</b>: Allow current context to be resumed by any
+ * <i>kernel-thread</i>. No effects if current context is not controlled under
+ * scheduler.
+ */
+inline void
+unpin()
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        fusion::at_c<2>(*ctx_tuple).pinned = false;
+    }
+}
+
+} // namespace boost::mmm::this_ctx
+
+} } // namespace boost::mmm
+
+#endif
@@ -0,0 +1,101 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DEADLINE_HPP
+#define BOOST_MMM_DEADLINE_HPP
+
+#include <stdexcept>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mpl/bool.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/current_context.hpp>
+#include <boost/mmm/detail/spawn_attribute.hpp>
+
+#include <boost/fusion/include/at.hpp>
+
+namespace boost { namespace mmm {
+
+/**
+ * Stored to the future of a <i>user-thread</i> which was shed by strategy
+ * before it started, since its deadline had passed.
+ */
+struct deadline_missed : public std::runtime_error
+{
+    deadline_missed()
+      : std::runtime_error("deadline of the context has passed before it started") {}
+}; // struct deadline_missed
+
+namespace detail {
+
+struct deadline_attribute
+{
+    void
+    apply(context_tuple &ctx) const BOOST_MMM_NOEXCEPT
+    {
+        fusion::at_c<4>(ctx).deadline = deadline;
+    }
+
+    chrono::steady_clock::time_point deadline;
+}; // struct deadline_attribute
+
+template <>
+struct is_spawn_attribute<deadline_attribute> : public mpl::true_ {};
+
+} // namespace boost::mmm::detail
+
+/**
+ * <b>Returns</b>: An attribute which sets deadline of spawned
+ * <i>user-thread</i> to abs_time, to be passed as first argument of
+ * scheduler::add_thread. Contexts are spawned without deadline by default,
+ * which is later than any time.
+ */
+inline detail::deadline_attribute
+with_deadline(chrono::steady_clock::time_point abs_time) BOOST_MMM_NOEXCEPT
+{
+    const detail::deadline_attribute attr = { abs_time };
+    return attr;
+}
+
+namespace this_ctx {
+
+/**
+ * <b>Effects</b>: Change deadline of current context to abs_time. It takes
+ * effect when the context is suspended next time. No effects if current
+ * context is not controlled under scheduler.
+ */
+inline void
+set_deadline(chrono::steady_clock::time_point abs_time)
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        fusion::at_c<4>(*ctx_tuple).deadline = abs_time;
+    }
+}
+
+/**
+ * <b>Returns</b>: Deadline of current context, or time_point::max() if current
+ * context has no deadline or is not controlled under scheduler.
+ */
+inline chrono::steady_clock::time_point
+get_deadline()
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        return fusion::at_c<4>(*ctx_tuple).deadline;
+    }
+    return (chrono::steady_clock::time_point::max)();
+}
+
+} // namespace boost::mmm::this_ctx
+
+} } // namespace boost::mmm
+
+#endif
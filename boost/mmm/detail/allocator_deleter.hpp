@@ -0,0 +1,71 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_ALLOCATOR_DELETER_HPP
+#define BOOST_MMM_DETAIL_ALLOCATOR_DELETER_HPP
+
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Deleter of an object constructed in storage given by allocation_guard.
+template <typename T, typename Allocator>
+struct allocator_deleter
+{
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(T)
+    alloc_type;
+
+    void
+    operator()(T *p) const
+    {
+        p->~T();
+        alloc_type().deallocate(p, 1);
+    }
+}; // template struct allocator_deleter
+
+// Storage of a T allocated by Allocator, which is deallocated unless
+// released, e.g. the constructor of T threw.
+template <typename T, typename Allocator>
+class allocation_guard : private noncopyable
+{
+    typedef typename allocator_deleter<T, Allocator>::alloc_type alloc_type;
+
+public:
+    allocation_guard()
+      : _m_p(alloc_type().allocate(1)) {}
+
+    ~allocation_guard()
+    {
+        if (_m_p) { alloc_type().deallocate(_m_p, 1); }
+    }
+
+    void *
+    get() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_p;
+    }
+
+    /**
+     * <b>Precondition</b>: A T is constructed at get().
+     *
+     * <b>Returns</b>: The T, to be deleted by allocator_deleter.
+     */
+    T *
+    release() BOOST_MMM_NOEXCEPT
+    {
+        T * const p = _m_p;
+        _m_p = 0;
+        return p;
+    }
+
+private:
+    T *_m_p;
+}; // template class allocation_guard
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_ALLOCATOR_DELETER_HPP
@@ -13,18 +13,17 @@
 #include <boost/noncopyable.hpp>
 
 #include <boost/container/vector.hpp>
-#include <boost/container/list.hpp>
-#include <boost/range/begin.hpp>
-#include <boost/range/end.hpp>
 
 #include <boost/mmm/detail/thread/thread.hpp>
 #include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/context_queue.hpp>
+#include <boost/mmm/detail/timer_wheel.hpp>
+#include <boost/mmm/detail/push_context.hpp>
 
 #include <boost/phoenix/core.hpp>
 #include <boost/phoenix/operator/self.hpp>
 #include <boost/phoenix/bind/bind_member_function.hpp>
 #include <boost/phoenix/fusion/at.hpp>
-#include <boost/mmm/detail/phoenix/move.hpp>
 
 #include <algorithm>
 #include <iterator>
@@ -82,21 +81,24 @@ class async_io_thread : private noncopyable
     typedef typename StrategyTraits::context_type context_type;
     typedef Alloc allocator_type;
 
-    typedef typename
-      BOOST_MMM_ALLOCATOR_REBIND(allocator_type)(context_type)
-    ctxact_alloc_type;
-    typedef container::list<context_type, ctxact_alloc_type> ctxact_vector;
+    // Contexts are parked in their hooks while polled, so that neither
+    // queueing nor erasing them allocates.
+    typedef context_queue<context_type> pending_queue;
 
     typedef typename
-      BOOST_MMM_ALLOCATOR_REBIND(allocator_type)(typename ctxact_vector::iterator)
-    ctxitr_alloc_type;
-    typedef container::vector<typename ctxact_vector::iterator, ctxitr_alloc_type> ctxitr_vector;
+      BOOST_MMM_ALLOCATOR_REBIND(allocator_type)(context_hook *)
+    ctxact_alloc_type;
+    typedef container::vector<context_hook *, ctxact_alloc_type> ctxact_vector;
 
     typedef typename
       BOOST_MMM_ALLOCATOR_REBIND(allocator_type)(pollfd)
     pfd_alloc_type;
     typedef container::vector<pollfd, pfd_alloc_type> pollfd_vector;
 
+    // Polled contexts which have deadlines are also linked to this through
+    // their hooks, and unlinked when restored.
+    typedef timer_wheel<context_type, allocator_type> deadlines_type;
+
     struct check_event
     {
         struct ignore
@@ -112,6 +114,17 @@ class async_io_thread : private noncopyable
         }
     }; // struct check_event
 
+    struct check_deadline
+    {
+        typedef typename check_event::ignore ignore;
+
+        bool
+        operator()(boost::tuple<ignore, ignore, context_hook *> ctxact) const
+        {
+            return !boost::get<2>(ctxact)->io_callback->timed_out();
+        }
+    }; // struct check_deadline
+
     template <typename Duration>
     int
     polling(Duration poll_TO, system::error_code &err_code)
@@ -140,7 +153,11 @@ class async_io_thread : private noncopyable
         while (!_m_terminate)
         {
             import_pendings();
-            const int ret = polling(poll_TO, err_code);
+            // Wake up by the earliest deadline of sleeping contexts too.
+            const chrono::nanoseconds timeout =
+              deadline_timeout(_m_scheduler_traits.timer_timeout(poll_TO));
+            const int ret = polling(timeout, err_code);
+            _m_scheduler_traits.expire_timers();
 
             if (!err_code && 0 < ret)
             {
@@ -148,15 +165,15 @@ class async_io_thread : private noncopyable
                   boost::tuple<
                     guard_iterator
                   , typename pollfd_vector::iterator
-                  , typename ctxitr_vector::iterator>
+                  , typename ctxact_vector::iterator>
                 iterator_tuple;
 
                 typedef zip_iterator<iterator_tuple> zipitr;
-                const zipitr zipend(boost::make_tuple(guard_iterator(), _m_pfds.end(), _m_ctxitr.end()));
+                const zipitr zipend(boost::make_tuple(guard_iterator(), _m_pfds.end(), _m_ctxact.end()));
 
                 zip_iterator<iterator_tuple> itr =
                   std::partition(
-                    zipitr(boost::make_tuple(guard_iterator(), _m_pfds.begin(), _m_ctxitr.begin()))
+                    zipitr(boost::make_tuple(guard_iterator(), _m_pfds.begin(), _m_ctxact.begin()))
                   , zipend
                   , check_event());
 
@@ -166,12 +183,27 @@ class async_io_thread : private noncopyable
                     erase<iterator_tuple>(itr, zipend);
                 }
             }
+            expire_deadlines<guard_iterator>();
         }
 
         // Cleanup all remained contexts.
         restore_contexts(
-          make_zip_iterator(boost::make_tuple(guard_iterator(), _m_pfds.begin(), _m_ctxitr.begin()))
-        , make_zip_iterator(boost::make_tuple(guard_iterator(), _m_pfds.end(), _m_ctxitr.end())));
+          make_zip_iterator(boost::make_tuple(guard_iterator(), _m_pfds.begin(), _m_ctxact.begin()))
+        , make_zip_iterator(boost::make_tuple(guard_iterator(), _m_pfds.end(), _m_ctxact.end())));
+        _m_pfds.clear();
+        _m_ctxact.clear();
+    }
+
+    // Resume on the kernel-thread which ran it last if possible. Must be
+    // called with lock.
+    void
+    restore_context(context_hook *hook)
+    {
+        if (hook->io_callback->has_deadline()) { _m_deadlines.cancel(hook); }
+        context_type ctx;
+        ctx.unpark(hook);
+        if (_m_scheduler_traits.push_affine(ctx)) { return; }
+        push_context(_m_strategy_traits, _m_scheduler_traits, boost::move(ctx));
     }
 
     template <typename ZipIterator>
@@ -180,14 +212,12 @@ class async_io_thread : private noncopyable
     {
         unique_lock<mutex> guard(_m_scheduler_traits.get_lock());
 
-        typedef void (StrategyTraits::*push_ctx)(SchedulerTraits, context_type);
         // Restore I/O ready contexts to schedular.
         std::for_each(itr, end
         , phoenix::bind(
-            static_cast<push_ctx>(&StrategyTraits::push_ctx)
-          , boost::ref(_m_strategy_traits)
-          , boost::ref(_m_scheduler_traits)
-          , phoenix::move(*phoenix::at_c<2>(phoenix::placeholders::arg1))));
+            &async_io_thread::restore_context
+          , boost::ref(*this)
+          , phoenix::at_c<2>(phoenix::placeholders::arg1)));
         _m_scheduler_traits.notify_all();
     }
 
@@ -198,51 +228,94 @@ class async_io_thread : private noncopyable
         const IteratorTuple &itr_tuple = itr.get_iterator_tuple(),
                             &end_tuple = end.get_iterator_tuple();
 
-        typedef typename ctxact_vector::iterator       ctxact_iterator;
-        typedef typename ctxact_vector::const_iterator ctxact_const_iterator;
-        typedef ctxact_iterator (ctxact_vector::*eraser)(ctxact_const_iterator);
-        // Erase resotred contexts.
-        std::for_each(
-          boost::get<2>(itr_tuple), boost::get<2>(end_tuple)
-        , phoenix::bind(
-            static_cast<eraser>(&ctxact_vector::erase)
-          , boost::ref(_m_ctxact)
-          , phoenix::placeholders::arg1));
+        // Erase restored contexts, which are already unparked.
         _m_pfds.erase(boost::get<1>(itr_tuple), boost::get<1>(end_tuple));
-        _m_ctxitr.erase(boost::get<2>(itr_tuple), boost::get<2>(end_tuple));
+        _m_ctxact.erase(boost::get<2>(itr_tuple), boost::get<2>(end_tuple));
     }
 
     void
     import_pendings()
     {
-        typedef typename ctxact_vector::iterator iterator;
-
-        // Should decrement end iterator due to some end iterator uses special
-        // version.
-        iterator itr = --_m_ctxact.end();
+        pending_queue imported;
         if (_m_pending_ctxs.size() != 0)
         {
             lock_guard<mutex> guard(_m_mtx);
-            std::copy(boost::begin(_m_pending_ctxs), boost::end(_m_pending_ctxs), back_move_inserter(_m_ctxact));
-            _m_pending_ctxs.clear();
+            imported.splice(_m_pending_ctxs);
         }
-        for (iterator end = _m_ctxact.end(); ++itr != end; )
+        while (context_hook *hook = imported.pop_hook())
         {
-            _m_ctxitr.push_back(itr);
-            _m_pfds.push_back(fusion::at_c<1>(*itr)->get_pollfd());
+            _m_ctxact.push_back(hook);
+            _m_pfds.push_back(hook->io_callback->get_pollfd());
+            if (hook->io_callback->has_deadline())
+            {
+                _m_deadlines.insert_hook(hook, hook->io_callback->get_deadline());
+            }
         }
-        BOOST_ASSERT(_m_ctxact.size() == _m_ctxitr.size());
         BOOST_ASSERT(_m_ctxact.size() == _m_pfds.size());
     }
 
+    // Shorter one of limit and time until the earliest deadline of polled
+    // contexts, rounded up to milliseconds as _m_timer_timeout of scheduler.
+    chrono::nanoseconds
+    deadline_timeout(chrono::nanoseconds limit)
+    {
+        typedef chrono::nanoseconds nanoseconds;
+        typedef chrono::milliseconds milliseconds;
+
+        typename deadlines_type::time_point deadline;
+        if (!_m_deadlines.next_expiry(deadline)) { return limit; }
+
+        const nanoseconds rest = deadline - deadlines_type::clock_type::now();
+        if (rest <= nanoseconds::zero()) { return nanoseconds::zero(); }
+
+        const nanoseconds until =
+          chrono::duration_cast<milliseconds>(rest + milliseconds(1) - nanoseconds(1));
+        return until < limit ? until : limit;
+    }
+
+    // Resume contexts whose deadline has passed before their events occurred,
+    // see io_callback_base::time_out.
+    template <typename GuardIterator>
+    void
+    expire_deadlines()
+    {
+        typename deadlines_type::expired_list expired;
+        if (!_m_deadlines.expire(deadlines_type::clock_type::now(), expired)) { return; }
+        while (context_hook *hook = expired.pop_hook()) { hook->io_callback->time_out(); }
+
+        typedef
+          boost::tuple<
+            GuardIterator
+          , typename pollfd_vector::iterator
+          , typename ctxact_vector::iterator>
+        iterator_tuple;
+
+        typedef zip_iterator<iterator_tuple> zipitr;
+        const zipitr zipend(boost::make_tuple(GuardIterator(), _m_pfds.end(), _m_ctxact.end()));
+
+        const zipitr itr =
+          std::partition(
+            zipitr(boost::make_tuple(GuardIterator(), _m_pfds.begin(), _m_ctxact.begin()))
+          , zipend
+          , check_deadline());
+
+        restore_contexts(itr, zipend);
+        erase<iterator_tuple>(itr, zipend);
+    }
+
 public:
+    /**
+     * <b>Effects</b>: Start polling. Deadlines of polled contexts are
+     * rounded up to timer_resolution, see timer_wheel.
+     */
     template <typename Rep, typename Period>
     explicit
     async_io_thread(SchedulerTraits scheduler_traits, StrategyTraits strategy_traits
-    , chrono::duration<Rep, Period> poll_TO)
+    , chrono::duration<Rep, Period> poll_TO
+    , chrono::steady_clock::duration timer_resolution, std::size_t timer_slots)
       : _m_scheduler_traits(scheduler_traits), _m_strategy_traits(strategy_traits)
-      , _m_th(&async_io_thread::exec<Rep, Period>, boost::ref(*this), poll_TO)
-      , _m_terminate(false) {}
+      , _m_deadlines(timer_resolution, timer_slots), _m_terminate(false)
+      , _m_th(&async_io_thread::exec<Rep, Period>, boost::ref(*this), poll_TO) {}
 
     ~async_io_thread()
     {
@@ -254,7 +327,7 @@ public:
     push_ctx(context_type ctx)
     {
         lock_guard<mutex> guard(_m_mtx);
-        _m_pending_ctxs.push_back(boost::move(ctx));
+        _m_pending_ctxs.push(boost::move(ctx));
     }
 
     bool
@@ -268,12 +341,13 @@ private:
     SchedulerTraits _m_scheduler_traits;
     StrategyTraits  _m_strategy_traits;
     mutex           _m_mtx;
-    thread          _m_th;
     ctxact_vector   _m_ctxact;
-    ctxitr_vector   _m_ctxitr;
-    ctxact_vector   _m_pending_ctxs;
+    pending_queue   _m_pending_ctxs;
     pollfd_vector   _m_pfds;
+    deadlines_type  _m_deadlines;
     atomic<bool>    _m_terminate;
+    // Declared last, since it uses others as soon as started.
+    thread          _m_th;
 }; // template class async_io_thread
 
 } } } // namespace boost::mmm::detail
@@ -0,0 +1,124 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_BUCKET_QUEUE_HPP
+#define BOOST_MMM_DETAIL_BUCKET_QUEUE_HPP
+
+#include <cstddef>
+#include <climits>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/move/move.hpp>
+
+#include <boost/mmm/detail/context_queue.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// FIFO queues of contexts for a fixed number of levels. Each operation takes
+// constant time; the highest non-empty level is found from a bitmap. Contexts
+// are linked through their hooks, so pushing allocates nothing.
+template <typename Context, std::size_t Levels>
+class bucket_queue
+{
+    BOOST_STATIC_ASSERT(0 < Levels && Levels <= sizeof(unsigned long) * CHAR_BIT);
+
+    typedef context_queue<Context> bucket_type;
+
+    static std::size_t
+    highest(unsigned long mask) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(mask);
+#if defined(__GNUC__)
+        return sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl(mask);
+#else
+        std::size_t level = 0;
+        while (mask >>= 1) { ++level; }
+        return level;
+#endif
+    }
+
+public:
+    typedef Context value_type;
+    typedef std::size_t size_type;
+
+    BOOST_STATIC_CONSTEXPR size_type levels = Levels;
+
+    bucket_queue()
+      : _m_mask(0), _m_size(0) {}
+
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_size;
+    }
+
+    size_type
+    size(size_type level) const BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(level < Levels);
+        return _m_buckets[level].size();
+    }
+
+    /**
+     * <b>Effects</b>: Push ctx to back of level.
+     */
+    void
+    push(size_type level, BOOST_RV_REF(Context) ctx) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(level < Levels);
+        _m_buckets[level].push(boost::move(ctx));
+        _m_mask |= 1ul << level;
+        ++_m_size;
+    }
+
+    /**
+     * <b>Precondition</b>: size() > 0
+     *
+     * <b>Effects</b>: Pop front of the highest non-empty level into ctx.
+     *
+     * <b>Returns</b>: The level which ctx was taken from.
+     */
+    size_type
+    pop(Context &ctx) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(_m_size);
+        const size_type level = highest(_m_mask);
+        bucket_type &bucket = _m_buckets[level];
+
+        bucket.pop(ctx);
+        if (bucket.empty()) { _m_mask &= ~(1ul << level); }
+        --_m_size;
+        return level;
+    }
+
+    /**
+     * <b>Effects</b>: Move all elements of lower levels to back of level, in
+     * order of their levels. Takes time linear in number of levels.
+     */
+    void
+    raise_all(size_type level) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(level < Levels);
+        bucket_type &to = _m_buckets[level];
+        for (size_type l = level; l--;)
+        {
+            to.splice(_m_buckets[l]);
+        }
+        _m_mask &= ~((1ul << level) - 1);
+        if (!to.empty()) { _m_mask |= 1ul << level; }
+    }
+
+private:
+    bucket_type   _m_buckets[Levels];
+    unsigned long _m_mask;
+    size_type     _m_size;
+}; // template class bucket_queue
+
+} } } // namespace boost::mmm::detail
+
+#endif
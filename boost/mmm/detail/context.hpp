@@ -7,6 +7,7 @@
 #define BOOST_MMM_DETAIL_CONTEXT_HPP
 
 #include <cstddef>
+#include <new>
 #include <boost/config.hpp>
 #include <boost/assert.hpp>
 #include <boost/cstdint.hpp>
@@ -19,24 +20,35 @@
 #include <boost/noncopyable.hpp>
 #include <boost/move/move.hpp>
 
-#include <boost/context/fcontext.hpp>
-#include <boost/context/stack_allocator.hpp>
-#include <boost/context/stack_utils.hpp>
+#include <boost/mmm/detail/context_switch.hpp>
+#include <boost/mmm/detail/stack_utils.hpp>
 
 #include <exception>
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
 
-#include <boost/function.hpp>
-#include <boost/phoenix/bind/bind_member_function.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/utility/typed_in_place_factory.hpp>
 
 #include <boost/checked_delete.hpp>
 #include <boost/interprocess/smart_ptr/unique_ptr.hpp>
 
 #include <boost/mmm/io/detail/poll.hpp>
+#include <boost/mmm/detail/stack_profiler.hpp>
+
+#include <boost/chrono/system_clocks.hpp>
 
 #include <boost/fusion/include/adapt_struct.hpp>
 
+// Bytes of function objects of contexts stored in data of them, larger ones
+// are placed below the data on the stack.
+#if !defined(BOOST_MMM_CONTEXT_INLINE_SIZE)
+#   define BOOST_MMM_CONTEXT_INLINE_SIZE (6 * sizeof(void *))
+#endif
+
 namespace boost { namespace mmm { namespace detail {
 
 struct context_exception : public std::logic_error
@@ -45,6 +57,186 @@ struct context_exception : public std::logic_error
       : std::logic_error(v) {}
 }; // struct context_exception
 
+class io_callback_base
+{
+protected:
+    typedef io::detail::polling_events event_type;
+
+    typedef chrono::steady_clock::time_point time_point;
+
+    explicit
+    io_callback_base(event_type::type event)
+      : _m_event(event), _m_deadline((time_point::max)()), _m_timed_out(false) {}
+
+    event_type::type
+    get_events() const { return _m_event; }
+
+    void
+    set_deadline(const time_point &deadline) { _m_deadline = deadline; }
+
+public:
+    virtual
+    ~io_callback_base() {}
+
+    bool
+    has_deadline() const { return _m_deadline != (time_point::max)(); }
+
+    const time_point &
+    get_deadline() const { return _m_deadline; }
+
+    // Called instead of operator()() if deadline has passed before events
+    // occurred, by the poller or kernels. done() becomes true.
+    void
+    time_out() { _m_timed_out = true; }
+
+    bool
+    timed_out() const { return _m_timed_out; }
+
+    virtual void
+    operator()() = 0;
+
+    virtual bool
+    check_events(system::error_code &) const = 0;
+
+    virtual bool
+    done() const = 0;
+
+    virtual bool
+    is_aggregatable() const { return false; }
+
+    virtual pollfd
+    get_pollfd() const
+    {
+        BOOST_THROW_EXCEPTION(std::runtime_error("non-supported operation"));
+    }
+
+private:
+    event_type::type _m_event;
+    time_point       _m_deadline;
+    bool             _m_timed_out;
+}; // class io_callback_base
+
+// Where a context prefers to be resumed.
+struct context_affinity
+{
+    BOOST_STATIC_CONSTEXPR std::size_t no_kernel = static_cast<std::size_t>(-1);
+
+    context_affinity()
+      : kernel(no_kernel), pinned(false) {}
+
+    // Index of the kernel-thread which ran the context last, or pinned to.
+    std::size_t kernel;
+    // Never resumed by other kernel-threads if true.
+    bool        pinned;
+}; // struct context_affinity
+
+// Request from a context to be resumed after deadline.
+struct context_timer
+{
+    typedef chrono::steady_clock::time_point time_point;
+
+    context_timer()
+      : armed(false), deadline() {}
+
+    bool       armed;
+    time_point deadline;
+}; // struct context_timer
+
+// Why a context was suspended last time.
+enum suspension_reason
+{
+    suspension_spawned
+  , suspension_yielded
+    // Resumed by the poller after I/O became ready, or pushed to be polled
+    // by kernels. Pushed again as yielded while polled but not ready.
+  , suspension_io
+  , suspension_timer
+    // Resumed by a synchronization primitive which it waited for.
+  , suspension_woken
+}; // enum suspension_reason
+
+// Attributes of a context, referred by strategies.
+struct context_attributes
+{
+    typedef chrono::steady_clock::time_point time_point;
+    typedef chrono::steady_clock::duration   duration;
+
+    context_attributes()
+      : priority(0), deadline((time_point::max)()), shed(false), group(0)
+      , reason(suspension_spawned), ran(duration::zero())
+      , level(0), used(duration::zero()), epoch(0), entry(0) {}
+
+    int         priority;
+    time_point  deadline;
+    // Set by strategies to abandon the context before calling its function.
+    bool        shed;
+    std::size_t group;
+
+    // Set by scheduler when suspended. ran is measured only if the strategy
+    // requires, see measures_run_time.
+    suspension_reason reason;
+    duration          ran;
+
+    // Bookkeeping of multi-level strategies.
+    std::size_t level;
+    duration    used;
+    std::size_t epoch;
+
+    // Entry function to record stack usage of, 0 unless profiling. See
+    // stack_profiler.
+    const void *entry;
+}; // struct context_attributes
+
+// Function object of a context, copied from F. If F is a typed in-place
+// factory, its value_type is constructed in place instead, so that it need
+// not be copyable.
+template <typename F, typename = void>
+struct context_function
+{
+    typedef F type;
+
+    static void
+    construct(const F &f, void *where)
+    {
+        new (where) F(f);
+    }
+}; // template struct context_function
+
+template <typename F>
+struct context_function<F
+, typename enable_if<is_base_of<typed_in_place_factory_base, F> >::type>
+{
+    typedef typename F::value_type type;
+
+    static void
+    construct(const F &f, void *where)
+    {
+        f.apply(where);
+    }
+}; // template struct context_function<F, E>
+
+// Scheduling state of a queued context, kept in data of the context which
+// lives as long as the context, so that queues link contexts without
+// allocating nodes. See context_tuple::park.
+struct context_hook
+{
+    context_hook()
+      : next(0), io_callback(0)
+      , timer_next(0), timer_link(0), timer_expiry(0) {}
+
+    context_hook       *next;
+    io_callback_base   *io_callback;
+    context_affinity   affinity;
+    context_timer      timer;
+    context_attributes attributes;
+
+    // Links of timer_wheel, apart from next so that a context can be queued
+    // and timed at once. Not touched by park() and unpark().
+    context_hook       *timer_next;
+    context_hook       **timer_link;
+    boost::uint64_t    timer_expiry;
+}; // struct context_hook
+
 struct context
 {
     BOOST_MOVABLE_BUT_NOT_COPYABLE(context)
@@ -55,7 +247,7 @@ private:
     void true_type_() {}
 #endif
 
-    struct context_data_ : private noncopyable
+    struct context_data_ : public context_hook, private noncopyable
     {
     private:
         enum status_t
@@ -65,6 +257,12 @@ private:
           , context_status_done
         }; // enum status_t
 
+        typedef void (*release_type)(context_data_ *);
+        typedef aligned_storage<BOOST_MMM_CONTEXT_INLINE_SIZE> buffer_type;
+
+        // Instantiated for each type of function objects, so that calling
+        // and destroying them are not dispatched indirectly.
+        template <typename F>
         static void
         _m_executer(intptr_t this_)
         {
@@ -72,71 +270,145 @@ private:
             // Due to dtor of any variables will be not called.
             context_data_ &self = *static_cast<context_data_ *>(reinterpret_cast<void *>(this_));
 
-            self.jump(0);
-            if (self._m_status != context_status_none)
+            // Entered first by jump() to run f, or by destructor with status
+            // none not to. Null if copying the function object failed.
+            if (F * const f = static_cast<F *>(self._m_func))
             {
-                try
+                if (self._m_status.load(memory_order_relaxed) != context_status_none)
                 {
-                    self._m_func();
-                }
-                catch (...)
-                {
-                    std::terminate();
+                    try
+                    {
+                        (*f)();
+                    }
+                    catch (...)
+                    {
+                        std::terminate();
+                    }
                 }
+                f->~F();
             }
 
-            self._m_status = context_status_done;
+            self._m_status.store(context_status_done, memory_order_relaxed);
             self.jump(0, true);
         }
 
+        // Stack is deallocated by the allocator stored on it, so copy it out
+        // before.
         template <typename A>
-        void
-        allocate_stack(std::size_t size, A alloc)
+        static void
+        release(context_data_ *data)
         {
-            void * const ptr = alloc.allocate(size);
-            BOOST_ASSERT(ptr);
-
-            _m_fc.fc_stack.base  = ptr;
-            _m_fc.fc_stack.limit = static_cast<char *>(ptr) - size;
-
-            _m_deallocate = phoenix::bind(&A::deallocate, alloc, ptr, size);
+            A * const stored = static_cast<A *>(data->_m_alloc);
+            A alloc(*stored);
+            void * const top = data->_m_top;
+            const std::size_t size = data->_m_size;
+
+            stored->~A();
+            data->~context_data_();
+            alloc.deallocate(top, size);
         }
 
-    public:
-        context_data_(function<void()> f, std::size_t size)
-          : _m_status(context_status_none), _m_fc(initialized_value)
-          , _m_c_pfc(&_m_ofc), _m_o_pfc(&_m_fc)
-          , _m_func(f)
+        static char *
+        align_down(char *p, std::size_t alignment) BOOST_MMM_NOEXCEPT
         {
-            allocate_stack(size, ctx::stack_allocator());
-            ctx::make_fcontext(&_m_fc, _m_executer);
+            return reinterpret_cast<char *>(
+              reinterpret_cast<uintptr_t>(p) & ~static_cast<uintptr_t>(alignment - 1));
+        }
 
-            jump(this);
+        // Placed at top of [top - size, top) which is the stack, and the
+        // stack grows from base below this. Not entered until first jump().
+        context_data_(void *top, std::size_t size, void *base, void (*executer)(intptr_t))
+          : _m_status(context_status_none), _m_inside(false)
+          , _m_func(0), _m_alloc(0), _m_release(0), _m_top(top), _m_size(size), _m_base(base)
+        {
+            context_switch::make(_m_switch, base, static_cast<char *>(base) - limit(), executer);
         }
 
         ~context_data_()
         {
-            if (_m_status == context_status_none) { jump(0, true); }
+            // Let not started one destroy its function object.
+            if (_m_status.load(memory_order_relaxed) == context_status_none) { jump(this, true); }
             if (!is_complete()) { std::terminate(); }
-            _m_deallocate();
         }
 
+    public:
+        /**
+         * <b>Effects</b>: Allocate a stack by alloc, and place data, copy of
+         * alloc and copy of f at its top, so that spawning allocates nothing
+         * but the stack. f is stored in data if not larger than
+         * BOOST_MMM_CONTEXT_INLINE_SIZE, or below it otherwise. If f is a
+         * typed in-place factory, the function object is constructed by it
+         * instead of copying. The stack is deallocated by the copy of alloc
+         * when destroyed.
+         */
+        template <typename Factory, typename A>
+        static context_data_ *
+        create(const Factory &f, std::size_t size, A alloc)
+        {
+            typedef typename context_function<Factory>::type F;
+
+            char * const top = static_cast<char *>(alloc.allocate(size));
+            BOOST_ASSERT(top);
+
+            char *p = align_down(top - sizeof(context_data_), 16);
+            void * const where = p;
+            p = align_down(p - sizeof(A), alignment_of<A>::value);
+            // Copying allocators does not throw.
+            A * const stored = new (p) A(alloc);
+            const bool inlined = sizeof(F) <= sizeof(buffer_type)
+                              && alignment_of<F>::value <= alignment_of<buffer_type>::value;
+            if (!inlined) { p = align_down(p - sizeof(F), alignment_of<F>::value); }
+            BOOST_ASSERT(top - size < p);
+
+            context_data_ * const data = new (where) context_data_(
+              top, size, align_down(p, 16), &_m_executer<F>);
+            data->_m_alloc   = stored;
+            data->_m_release = &release<A>;
+
+            void * const func = inlined ? data->_m_buffer.address() : p;
+            try
+            {
+                context_function<Factory>::construct(f, func);
+            }
+            catch (...)
+            {
+                destroy(data);
+                throw;
+            }
+            data->_m_func = func;
+            return data;
+        }
+
+        static void
+        destroy(context_data_ *data)
+        {
+            data->_m_release(data);
+        }
+
+        // Resumes the context from outside, or suspends it from inside. Status
+        // is touched only by the kernel-thread running the context, and
+        // handing it over to others is ordered by the queues.
         intptr_t
         jump(intptr_t v = 0, bool jump_anyway = false)
         {
-            BOOST_ASSERT(_m_c_pfc && _m_o_pfc);
-
             if (!jump_anyway)
             {
                 if (is_complete())
                 {
                     BOOST_THROW_EXCEPTION(context_exception("This context is already done ..."));
                 }
-                _m_status = context_status_run;
+                // First one enters _m_executer, which takes data by v.
+                if (_m_status.load(memory_order_relaxed) == context_status_none)
+                {
+                    v = reinterpret_cast<intptr_t>(static_cast<void *>(this));
+                }
+                _m_status.store(context_status_run, memory_order_relaxed);
             }
 
-            boost::swap(_m_c_pfc, _m_o_pfc);
-            return ctx::jump_fcontext(_m_o_pfc, _m_c_pfc, v);
+            _m_inside = !_m_inside;
+            return _m_inside
+              ? context_switch::resume(_m_switch, v)
+              : context_switch::suspend(_m_switch, v);
         }
 
         template <typename T>
@@ -149,17 +421,44 @@ private:
         bool
         is_complete() const BOOST_MMM_NOEXCEPT
         {
-            return _m_status == context_status_done;
+            return _m_status.load(memory_order_relaxed) == context_status_done;
+        }
+
+        std::size_t
+        stack_used() const BOOST_MMM_NOEXCEPT
+        {
+            return used_stack(limit(), _m_base);
         }
 
     private:
-        atomic<status_t> _m_status;
-        ctx::fcontext_t  _m_ofc, _m_fc;
-        ctx::fcontext_t  *_m_c_pfc, *_m_o_pfc;
-        function<void()> _m_func;
-        function<void()> _m_deallocate;
+        char *
+        limit() const BOOST_MMM_NOEXCEPT
+        {
+            return static_cast<char *>(_m_top) - _m_size;
+        }
+
+        atomic<status_t>      _m_status;
+        // True while running on the context.
+        bool                  _m_inside;
+        context_switch::state _m_switch;
+        void                  *_m_func;
+        void                  *_m_alloc;
+        release_type          _m_release;
+        void                  *_m_top;
+        std::size_t           _m_size;
+        void                  *_m_base;
+        buffer_type           _m_buffer;
     }; // struct context::context_data_
 
+    struct data_deleter
+    {
+        void
+        operator()(context_data_ *data) const
+        {
+            context_data_::destroy(data);
+        }
+    }; // struct data_deleter
+
     template <typename T, typename D = checked_deleter<T> >
     struct unique_ptr_
     {
@@ -172,11 +471,21 @@ public:
     template <typename F>
     explicit
     context(F f, std::size_t size = ctx::default_stacksize())
-      : _m_data(new context_data_(f, size)) {}
+      : _m_data(context_data_::create(f, size, ctx::stack_allocator())) {}
+
+    // Stack is allocated by alloc, and deallocated by copy of it.
+    template <typename F, typename StackAllocator>
+    context(F f, std::size_t size, StackAllocator alloc)
+      : _m_data(context_data_::create(f, size, alloc)) {}
 
     context(BOOST_RV_REF(context) other) BOOST_MMM_NOEXCEPT
       : _m_data(boost::move(other._m_data)) {}
 
+    // Take back the ownership released by release().
+    explicit
+    context(context_hook *hook) BOOST_MMM_NOEXCEPT
+      : _m_data(static_cast<context_data_ *>(hook)) {}
+
     context &
     operator=(BOOST_RV_REF(context) other) BOOST_MMM_NOEXCEPT
     {
@@ -231,8 +540,26 @@ public:
         BOOST_THROW_EXCEPTION(context_exception("This context is not valid"));
     }
 
+    /**
+     * <b>Returns</b>: Bytes of the stack which have been used, valid only if
+     * the stack was filled with stack_canary before.
+     */
+    std::size_t
+    stack_used() const
+    {
+        if (*this) { return _m_data->stack_used(); }
+        BOOST_THROW_EXCEPTION(context_exception("This context is not valid"));
+    }
+
+    // Release the ownership of data, and *this becomes not valid.
+    context_hook *
+    release() BOOST_MMM_NOEXCEPT
+    {
+        return _m_data.release();
+    }
+
 private:
-    unique_ptr_<context_data_>::type _m_data;
+    unique_ptr_<context_data_, data_deleter>::type _m_data;
 }; // struct context
 
 inline void
@@ -241,44 +568,6 @@ swap(context &left, context &right) BOOST_MMM_NOEXCEPT
     left.swap(right);
 }
 
-class io_callback_base
-{
-protected:
-    typedef io::detail::polling_events event_type;
-
-    explicit
-    io_callback_base(event_type::type event)
-      : _m_event(event) {}
-
-    event_type::type
-    get_events() const { return _m_event; }
-
-public:
-    virtual
-    ~io_callback_base() {}
-
-    virtual void
-    operator()() = 0;
-
-    virtual bool
-    check_events(system::error_code &) const = 0;
-
-    virtual bool
-    done() const = 0;
-
-    virtual bool
-    is_aggregatable() const { return false; }
-
-    virtual pollfd
-    get_pollfd() const
-    {
-        BOOST_THROW_EXCEPTION(std::runtime_error("non-supported operation"));
-    }
-
-private:
-    event_type::type _m_event;
-}; // class io_callback_base
-
 struct context_tuple
 {
     BOOST_MOVABLE_BUT_NOT_COPYABLE(context_tuple)
@@ -286,15 +575,20 @@ struct context_tuple
 public:
     typedef context context_type;
 
-    context_tuple() : _m_ctx(), _m_io_callback() {}
+    context_tuple()
+      : _m_ctx(), _m_io_callback(), _m_affinity(), _m_timer(), _m_attributes() {}
 
     explicit
     context_tuple(BOOST_RV_REF(context_type) ctx, io_callback_base *callback)
-      : _m_ctx(boost::move(ctx)), _m_io_callback(callback) {}
+      : _m_ctx(boost::move(ctx)), _m_io_callback(callback)
+      , _m_affinity(), _m_timer(), _m_attributes() {}
 
     context_tuple(BOOST_RV_REF(context_tuple) other)
       : _m_ctx(boost::move(other._m_ctx))
       , _m_io_callback(other._m_io_callback)
+      , _m_affinity(other._m_affinity)
+      , _m_timer(other._m_timer)
+      , _m_attributes(other._m_attributes)
     {
         other._m_io_callback = initialized_value;
     }
@@ -311,10 +605,44 @@ public:
     {
         boost::swap(_m_ctx        , other._m_ctx);
         boost::swap(_m_io_callback, other._m_io_callback);
+        boost::swap(_m_affinity   , other._m_affinity);
+        boost::swap(_m_timer      , other._m_timer);
+        boost::swap(_m_attributes , other._m_attributes);
+    }
+
+    // Move *this into hook of its context, to be linked by queues. *this
+    // becomes not-a-context.
+    context_hook *
+    park() BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(_m_ctx);
+        context_hook *hook = _m_ctx.release();
+        hook->next        = 0;
+        hook->io_callback = _m_io_callback;
+        hook->affinity    = _m_affinity;
+        hook->timer       = _m_timer;
+        hook->attributes  = _m_attributes;
+        _m_io_callback = initialized_value;
+        return hook;
+    }
+
+    // Move a context parked by park() back into *this.
+    void
+    unpark(context_hook *hook) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(hook);
+        context_type(hook).swap(_m_ctx);
+        _m_io_callback = hook->io_callback;
+        _m_affinity    = hook->affinity;
+        _m_timer       = hook->timer;
+        _m_attributes  = hook->attributes;
     }
 
-    context_type     _m_ctx;
-    io_callback_base *_m_io_callback;
+    context_type       _m_ctx;
+    io_callback_base   *_m_io_callback;
+    context_affinity   _m_affinity;
+    context_timer      _m_timer;
+    context_attributes _m_attributes;
 }; // struct context_tuple
 
 inline void
@@ -329,6 +657,9 @@ BOOST_FUSION_ADAPT_STRUCT(
   boost::mmm::detail::context_tuple
 , (boost::mmm::detail::context_tuple::context_type, _m_ctx)
   (boost::mmm::detail::io_callback_base *         , _m_io_callback)
+  (boost::mmm::detail::context_affinity           , _m_affinity)
+  (boost::mmm::detail::context_timer              , _m_timer)
+  (boost::mmm::detail::context_attributes         , _m_attributes)
   )
 
 #endif // BOOST_MMM_DETAIL_CONTEXT_HPP
@@ -13,6 +13,7 @@
 #include <boost/noncopyable.hpp>
 
 #include <boost/mmm/scheduler_traits.hpp>
+#include <boost/mmm/detail/push_context.hpp>
 
 namespace boost { namespace mmm { namespace detail {
 
@@ -43,7 +44,7 @@ public:
         // Back context to pool if it still not finished.
         if (is_suspended())
         {
-            _m_strategy.push_ctx(_m_scheduler, move(_m_ctx));
+            push_context(_m_strategy, _m_scheduler, move(_m_ctx));
         }
     }
 
@@ -0,0 +1,41 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_NODE_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_NODE_HPP
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/move/move.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Lock-free queues can hold only trivially copyable values, so contexts are
+// parked into their hooks, which live on their own stacks, while they are
+// queued. Queuing allocates nothing.
+template <typename Context>
+struct context_node
+{
+    typedef context_hook *pointer;
+
+    static pointer
+    create(BOOST_RV_REF(Context) ctx) BOOST_MMM_NOEXCEPT
+    {
+        return static_cast<Context &>(ctx).park();
+    }
+
+    static void
+    release(pointer p, Context &ctx) BOOST_MMM_NOEXCEPT
+    {
+        ctx.unpark(p);
+    }
+}; // template struct context_node
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,129 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_QUEUE_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_QUEUE_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/move/move.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Intrusive FIFO of contexts linked through their hooks. Pushing and popping
+// never allocate. See context_tuple::park.
+template <typename Context>
+class context_queue : private noncopyable
+{
+public:
+    typedef Context value_type;
+    typedef std::size_t size_type;
+
+    context_queue()
+      : _m_head(0), _m_tail(0), _m_size(0) {}
+
+    ~context_queue()
+    {
+        // Owns queued contexts, each popped one is destroyed by next pop.
+        Context ctx;
+        while (pop(ctx)) {}
+    }
+
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_size;
+    }
+
+    bool
+    empty() const BOOST_MMM_NOEXCEPT
+    {
+        return !_m_size;
+    }
+
+    void
+    push(BOOST_RV_REF(Context) ctx) BOOST_MMM_NOEXCEPT
+    {
+        Context &c = ctx;
+        push_hook(c.park());
+    }
+
+    /**
+     * <b>Effects</b>: Pop the oldest context into ctx.
+     *
+     * <b>Returns</b>: false iff empty.
+     */
+    bool
+    pop(Context &ctx) BOOST_MMM_NOEXCEPT
+    {
+        if (context_hook *hook = pop_hook())
+        {
+            ctx.unpark(hook);
+            return true;
+        }
+        return false;
+    }
+
+    void
+    push_hook(context_hook *hook) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(hook);
+        hook->next = 0;
+        if (_m_tail) { _m_tail->next = hook; }
+        else         { _m_head = hook; }
+        _m_tail = hook;
+        ++_m_size;
+    }
+
+    /**
+     * <b>Returns</b>: Hook of the oldest context, which the caller owns, or
+     * null iff empty.
+     */
+    context_hook *
+    pop_hook() BOOST_MMM_NOEXCEPT
+    {
+        context_hook *hook = _m_head;
+        if (!hook) { return 0; }
+
+        _m_head = hook->next;
+        if (!_m_head) { _m_tail = 0; }
+        hook->next = 0;
+        --_m_size;
+        return hook;
+    }
+
+    /**
+     * <b>Effects</b>: Move all of contexts in other to the back, in same
+     * order. other becomes empty.
+     */
+    void
+    splice(context_queue &other) BOOST_MMM_NOEXCEPT
+    {
+        if (!other._m_head) { return; }
+
+        if (_m_tail) { _m_tail->next = other._m_head; }
+        else         { _m_head = other._m_head; }
+        _m_tail = other._m_tail;
+        _m_size += other._m_size;
+
+        other._m_head = other._m_tail = 0;
+        other._m_size = 0;
+    }
+
+private:
+    context_hook *_m_head;
+    context_hook *_m_tail;
+    size_type    _m_size;
+}; // template class context_queue
+
+} } } // namespace boost::mmm::detail
+
+#endif
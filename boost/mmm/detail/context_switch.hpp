@@ -0,0 +1,61 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_SWITCH_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_SWITCH_HPP
+
+#include <boost/mmm/detail/workaround.hpp>
+
+// Backends of context switching. Each of them provides
+//   state                 : Registers of a context and of its resumer.
+//   make(st, base, size, entry)
+//                         : Make st to call entry(v) on [base - size, base)
+//                           when resumed first by v. entry never returns.
+//   resume(st, v)         : Switch from the resumer into the context.
+//   suspend(st, v)        : Switch from the context back to the resumer.
+// Both of resume and suspend return v given to the other side.
+#define BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT 1 // fcontext_t of trunk Boost.Context
+#define BOOST_MMM_CONTEXT_SWITCH_FCONTEXT       2 // fcontext_t of Boost.Context 1.61 or later
+#define BOOST_MMM_CONTEXT_SWITCH_UCONTEXT       3 // POSIX ucontext, a system call each switch
+#define BOOST_MMM_CONTEXT_SWITCH_ASM            4 // Callee-saved registers, x86-64 and AArch64
+
+#if !defined(BOOST_MMM_CONTEXT_SWITCH)
+#   define BOOST_MMM_CONTEXT_SWITCH BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT
+#endif
+
+// Zero not to save floating-point control words (MXCSR and x87 control word,
+// or FPCR) across switches, if contexts never change rounding modes nor
+// exception masks. Not supported by the ucontext backend.
+#if !defined(BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU)
+#   define BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU 1
+#endif
+
+#if BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT
+#   include <boost/mmm/detail/context_switch/trunk_fcontext.hpp>
+#elif BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_FCONTEXT
+#   include <boost/mmm/detail/context_switch/fcontext.hpp>
+#elif BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_UCONTEXT
+#   include <boost/mmm/detail/context_switch/ucontext.hpp>
+#elif BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_ASM
+#   include <boost/mmm/detail/context_switch/asm.hpp>
+#else
+#   error Unknown BOOST_MMM_CONTEXT_SWITCH
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+#if BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT
+typedef trunk_fcontext_switch context_switch;
+#elif BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_FCONTEXT
+typedef fcontext_switch context_switch;
+#elif BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_UCONTEXT
+typedef ucontext_switch context_switch;
+#else
+typedef asm_switch context_switch;
+#endif
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_CONTEXT_SWITCH_HPP
@@ -0,0 +1,107 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_SWITCH_ASM_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_SWITCH_ASM_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/cstdint.hpp>
+
+#if !(defined(__x86_64__) || defined(__aarch64__)) || !defined(__ELF__)
+#   error The assembly context switch supports x86-64 and AArch64 ELF only
+#endif
+
+// Defined in libs/mmm/src/context_switch.cpp. Push callee-saved registers
+// (and FPU control words unless _nofpu) onto the current stack, store the
+// stack pointer to *from, restore registers from to, and return v there.
+extern "C" intptr_t
+boost_mmm_switch_context(void **from, void *to, intptr_t v);
+
+extern "C" intptr_t
+boost_mmm_switch_context_nofpu(void **from, void *to, intptr_t v);
+
+// Called by returning from the first switch into a context, with its entry
+// in a callee-saved register and v in the first argument register.
+extern "C" void
+boost_mmm_switch_trampoline();
+
+namespace boost { namespace mmm { namespace detail {
+
+// Switches only callee-saved registers and the stack pointer, and FPU
+// control words if BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU.
+struct asm_switch
+{
+    struct state
+    {
+        void *self;
+        void *caller;
+    }; // struct state
+
+    static void
+    make(state &st, void *base, std::size_t, void (*entry)(intptr_t))
+    {
+        void **sp = reinterpret_cast<void **>(
+          reinterpret_cast<uintptr_t>(base) & ~static_cast<uintptr_t>(15));
+#if defined(__x86_64__)
+        // Popped by the switch: control words, r12 to r15, rbx, rbp, and
+        // returns to the trampoline.
+        *--sp = 0;
+        *--sp = reinterpret_cast<void *>(&boost_mmm_switch_trampoline);
+        *--sp = 0;
+        *--sp = 0;
+        *--sp = 0;
+        *--sp = 0;
+        *--sp = 0;
+        *--sp = reinterpret_cast<void *>(entry);
+        // Control words of the creator, since loading different ones on each
+        // switch is slow.
+        --sp;
+        __asm__ __volatile__ ("stmxcsr %0\n\tfnstcw %1"
+          : "=m"(*reinterpret_cast<uint32_t *>(sp))
+          , "=m"(*(reinterpret_cast<uint16_t *>(sp) + 2)));
+#else
+        // Loaded by the switch: d8 to d15, x19 to x30 and FPCR, where x19 is
+        // the entry and x30 is the trampoline.
+        sp -= 22;
+        for (int i = 0; i < 22; ++i) { sp[i] = 0; }
+        sp[8]  = reinterpret_cast<void *>(entry);
+        sp[19] = reinterpret_cast<void *>(&boost_mmm_switch_trampoline);
+        // FPCR of the creator, see above.
+        uint64_t fpcr;
+        __asm__ __volatile__ ("mrs %0, fpcr" : "=r"(fpcr));
+        sp[20] = reinterpret_cast<void *>(fpcr);
+#endif
+        st.self   = sp;
+        st.caller = 0;
+    }
+
+    static intptr_t
+    resume(state &st, intptr_t v)
+    {
+        return switch_context(&st.caller, st.self, v);
+    }
+
+    static intptr_t
+    suspend(state &st, intptr_t v)
+    {
+        return switch_context(&st.self, st.caller, v);
+    }
+
+private:
+    static intptr_t
+    switch_context(void **from, void *to, intptr_t v)
+    {
+#if BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU
+        return boost_mmm_switch_context(from, to, v);
+#else
+        return boost_mmm_switch_context_nofpu(from, to, v);
+#endif
+    }
+}; // struct asm_switch
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_CONTEXT_SWITCH_ASM_HPP
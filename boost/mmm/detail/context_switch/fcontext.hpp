@@ -0,0 +1,73 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_SWITCH_FCONTEXT_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_SWITCH_FCONTEXT_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/context/detail/fcontext.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Switches by jump_fcontext of Boost.Context 1.61 or later, which gives
+// continuation of the other side back on each switch. Values are passed
+// through state, and only address of it is transferred. Whether FPU control
+// words are saved is decided when Boost.Context is built.
+struct fcontext_switch
+{
+private:
+    typedef ::boost::context::detail::fcontext_t fcontext_t;
+    typedef ::boost::context::detail::transfer_t transfer_t;
+
+public:
+    struct state
+    {
+        fcontext_t self;
+        fcontext_t caller;
+        void       (*entry)(intptr_t);
+        intptr_t   value;
+    }; // struct state
+
+    static void
+    make(state &st, void *base, std::size_t size, void (*entry)(intptr_t))
+    {
+        st.self   = ::boost::context::detail::make_fcontext(base, size, &trampoline);
+        st.caller = 0;
+        st.entry  = entry;
+        st.value  = 0;
+    }
+
+    static intptr_t
+    resume(state &st, intptr_t v)
+    {
+        st.value = v;
+        st.self = ::boost::context::detail::jump_fcontext(st.self, &st).fctx;
+        return st.value;
+    }
+
+    static intptr_t
+    suspend(state &st, intptr_t v)
+    {
+        st.value = v;
+        st.caller = ::boost::context::detail::jump_fcontext(st.caller, &st).fctx;
+        return st.value;
+    }
+
+private:
+    static void
+    trampoline(transfer_t t)
+    {
+        state &st = *static_cast<state *>(t.data);
+        st.caller = t.fctx;
+        st.entry(st.value);
+    }
+}; // struct fcontext_switch
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_CONTEXT_SWITCH_FCONTEXT_HPP
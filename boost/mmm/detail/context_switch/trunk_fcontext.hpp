@@ -0,0 +1,50 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_SWITCH_TRUNK_FCONTEXT_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_SWITCH_TRUNK_FCONTEXT_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/context/fcontext.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Switches by ::boost::ctx::jump_fcontext, which passes v to entry at first.
+struct trunk_fcontext_switch
+{
+    struct state
+    {
+        ::boost::ctx::fcontext_t self;
+        ::boost::ctx::fcontext_t caller;
+    }; // struct state
+
+    static void
+    make(state &st, void *base, std::size_t size, void (*entry)(intptr_t))
+    {
+        st.self = st.caller = ::boost::ctx::fcontext_t();
+        st.self.fc_stack.base  = base;
+        st.self.fc_stack.limit = static_cast<char *>(base) - size;
+        ::boost::ctx::make_fcontext(&st.self, entry);
+    }
+
+    static intptr_t
+    resume(state &st, intptr_t v)
+    {
+        return ::boost::ctx::jump_fcontext(&st.caller, &st.self, v, BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU != 0);
+    }
+
+    static intptr_t
+    suspend(state &st, intptr_t v)
+    {
+        return ::boost::ctx::jump_fcontext(&st.self, &st.caller, v, BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU != 0);
+    }
+}; // struct trunk_fcontext_switch
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_CONTEXT_SWITCH_TRUNK_FCONTEXT_HPP
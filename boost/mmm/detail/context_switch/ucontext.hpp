@@ -0,0 +1,79 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CONTEXT_SWITCH_UCONTEXT_HPP
+#define BOOST_MMM_DETAIL_CONTEXT_SWITCH_UCONTEXT_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/cstdint.hpp>
+
+#include <stdexcept>
+#include <boost/throw_exception.hpp>
+
+#include <ucontext.h>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Switches by swapcontext, portable among POSIX systems but saves the signal
+// mask by a system call each time. Values are passed through state.
+struct ucontext_switch
+{
+    struct state
+    {
+        ucontext_t self;
+        ucontext_t caller;
+        void       (*entry)(intptr_t);
+        intptr_t   value;
+    }; // struct state
+
+    static void
+    make(state &st, void *base, std::size_t size, void (*entry)(intptr_t))
+    {
+        if (::getcontext(&st.self) != 0)
+        {
+            BOOST_THROW_EXCEPTION(std::runtime_error("getcontext failed"));
+        }
+        st.self.uc_stack.ss_sp   = static_cast<char *>(base) - size;
+        st.self.uc_stack.ss_size = size;
+        st.self.uc_link          = 0;
+        st.entry = entry;
+        st.value = 0;
+
+        // Arguments of makecontext are ints, so split address of st.
+        const uintptr_t p = reinterpret_cast<uintptr_t>(&st);
+        ::makecontext(&st.self, reinterpret_cast<void (*)()>(&trampoline), 2
+        , static_cast<unsigned>(p >> 16 >> 16), static_cast<unsigned>(p));
+    }
+
+    static intptr_t
+    resume(state &st, intptr_t v)
+    {
+        st.value = v;
+        ::swapcontext(&st.caller, &st.self);
+        return st.value;
+    }
+
+    static intptr_t
+    suspend(state &st, intptr_t v)
+    {
+        st.value = v;
+        ::swapcontext(&st.self, &st.caller);
+        return st.value;
+    }
+
+private:
+    static void
+    trampoline(unsigned hi, unsigned lo)
+    {
+        const uintptr_t p = (static_cast<uintptr_t>(hi) << 16 << 16) | lo;
+        state &st = *reinterpret_cast<state *>(p);
+        st.entry(st.value);
+    }
+}; // struct ucontext_switch
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_CONTEXT_SWITCH_UCONTEXT_HPP
@@ -0,0 +1,22 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_CPU_QUOTA_HPP
+#define BOOST_MMM_DETAIL_CPU_QUOTA_HPP
+
+#include <cstddef>
+
+namespace boost { namespace mmm { namespace detail {
+
+/**
+ * <b>Returns</b>: Number of hardware threads this process may use, limited by
+ * CPU quota of the cgroup if any. Always >= 1.
+ */
+std::size_t
+available_concurrency();
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,347 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_EVENTCOUNT_HPP
+#define BOOST_MMM_DETAIL_EVENTCOUNT_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/static_assert.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#if defined(__linux__)
+#   define BOOST_MMM_DETAIL_HAS_FUTEX
+#endif
+
+#if defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#else
+#include <boost/thread/condition_variable.hpp>
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+inline void
+cpu_relax() BOOST_MMM_NOEXCEPT
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#endif
+}
+
+// Single waiter parking slot, owned by a kernel-thread. unpark() issues a
+// syscall only if the owner is actually sleeping.
+class parker : private noncopyable
+{
+    enum state_t
+    {
+        _st_idle
+      , _st_notified
+      , _st_sleeping
+    }; // enum state_t
+
+#if defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+    BOOST_STATIC_ASSERT(sizeof(atomic<int>) == sizeof(int));
+
+    int *
+    futex_addr() BOOST_MMM_NOEXCEPT
+    {
+        return reinterpret_cast<int *>(&_m_state);
+    }
+#endif
+
+    friend class eventcount;
+
+public:
+    typedef chrono::steady_clock::time_point time_point;
+
+    parker()
+      : _m_state(_st_idle), _m_next(0) {}
+
+    /**
+     * <b>Effects</b>: Make next park() block until unpark().
+     */
+    void
+    reset() BOOST_MMM_NOEXCEPT
+    {
+        _m_state.store(_st_idle, memory_order_relaxed);
+    }
+
+    /**
+     * <b>Effects</b>: Block until unpark() is called after reset().
+     */
+    void
+    park()
+    {
+        int expected = _st_idle;
+        if (!_m_state.compare_exchange_strong(expected, _st_sleeping))
+        {
+            // Already notified.
+            return;
+        }
+
+#if defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+        while (_m_state.load(memory_order_acquire) == _st_sleeping)
+        {
+            ::syscall(SYS_futex, futex_addr(), FUTEX_WAIT_PRIVATE, _st_sleeping, 0, 0, 0);
+        }
+#else
+        unique_lock<mutex> guard(_m_mtx);
+        while (_m_state.load(memory_order_acquire) == _st_sleeping)
+        {
+            _m_cond.wait(guard);
+        }
+#endif
+    }
+
+    /**
+     * <b>Effects</b>: Block until unpark() is called after reset(), or
+     * deadline is reached.
+     *
+     * <b>Returns</b>: false iff timed out.
+     */
+    bool
+    park_until(const time_point &deadline)
+    {
+        int expected = _st_idle;
+        if (!_m_state.compare_exchange_strong(expected, _st_sleeping))
+        {
+            // Already notified.
+            return true;
+        }
+
+#if defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+        while (_m_state.load(memory_order_acquire) == _st_sleeping)
+        {
+            const chrono::nanoseconds::rep rest =
+              chrono::nanoseconds(deadline - chrono::steady_clock::now()).count();
+            if (rest <= 0) { break; }
+
+            timespec ts;
+            ts.tv_sec  = static_cast<std::time_t>(rest / 1000000000);
+            ts.tv_nsec = static_cast<long>(rest % 1000000000);
+            ::syscall(SYS_futex, futex_addr(), FUTEX_WAIT_PRIVATE, _st_sleeping, &ts, 0, 0);
+        }
+#else
+        {
+            unique_lock<mutex> guard(_m_mtx);
+            while (_m_state.load(memory_order_acquire) == _st_sleeping)
+            {
+                if (_m_cond.wait_until(guard, deadline) == cv_status::timeout) { break; }
+            }
+        }
+#endif
+
+        // Withdraw from sleeping unless unpark() has already been issued.
+        expected = _st_sleeping;
+        return !_m_state.compare_exchange_strong(expected, _st_idle);
+    }
+
+    /**
+     * <b>Effects</b>: Wake up the owner.
+     */
+    void
+    unpark()
+    {
+        if (_m_state.exchange(_st_notified) != _st_sleeping) { return; }
+
+#if defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+        ::syscall(SYS_futex, futex_addr(), FUTEX_WAKE_PRIVATE, 1, 0, 0, 0);
+#else
+        lock_guard<mutex> guard(_m_mtx);
+        _m_cond.notify_one();
+#endif
+    }
+
+private:
+    // Spin until unpark() by a notifier which has already taken *this out of
+    // the list, so that neither the list nor _m_next is touched by it after.
+    void
+    await_unpark() const BOOST_MMM_NOEXCEPT
+    {
+        while (_m_state.load(memory_order_acquire) != _st_notified) { cpu_relax(); }
+    }
+
+    atomic<int> _m_state;
+    parker      *_m_next;
+#if !defined(BOOST_MMM_DETAIL_HAS_FUTEX)
+    mutex              _m_mtx;
+    condition_variable _m_cond;
+#endif
+}; // class parker
+
+// Eventcount over parkers. Waiters should follow:
+//
+//     key = ec.prepare_wait();
+//     if (/* condition is satisfied */) { return; }
+//     ec.commit_wait(parker, key);
+//
+// and notifiers should make the condition satisfied before calling notify.
+// notify() takes no lock unless any waiter is parked.
+class eventcount : private noncopyable
+{
+public:
+    typedef unsigned key_type;
+
+    eventcount()
+      : _m_epoch(0), _m_parked_count(0), _m_parked(0) {}
+
+    key_type
+    prepare_wait() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_epoch.load();
+    }
+
+    /**
+     * <b>Returns</b>: true iff any notification was issued after
+     * prepare_wait returned key.
+     */
+    bool
+    changed(key_type key) const BOOST_MMM_NOEXCEPT
+    {
+        return _m_epoch.load(memory_order_acquire) != key;
+    }
+
+    /**
+     * <b>Effects</b>: Park p unless notified after prepare_wait.
+     */
+    void
+    commit_wait(parker &p, key_type key)
+    {
+        if (_m_enlist(p, key)) { p.park(); }
+    }
+
+    /**
+     * <b>Effects</b>: Park p unless notified after prepare_wait, but at most
+     * until deadline.
+     */
+    void
+    commit_wait(parker &p, key_type key, const parker::time_point &deadline)
+    {
+        if (!_m_enlist(p, key) || p.park_until(deadline)) { return; }
+
+        // Timed out; p might have been already removed by notify, which
+        // unparks p after unlocking. p must not be enlisted again until then.
+        {
+            lock_guard<mutex> guard(_m_mtx);
+            if (_m_unlink(p)) { return; }
+        }
+        p.await_unpark();
+    }
+
+    /**
+     * <b>Effects</b>: Wake up at most n parked waiters.
+     */
+    void
+    notify(std::size_t n)
+    {
+        ++_m_epoch;
+        if (!_m_parked_count.load()) { return; }
+
+        parker *woken = 0;
+        {
+            lock_guard<mutex> guard(_m_mtx);
+            for (; n && _m_parked; --n)
+            {
+                parker *p = _m_parked;
+                _m_parked = p->_m_next;
+                p->_m_next = woken;
+                woken = p;
+                --_m_parked_count;
+            }
+        }
+
+        while (woken)
+        {
+            // Should read next before unpark; woken one might park again.
+            parker *next = woken->_m_next;
+            woken->unpark();
+            woken = next;
+        }
+    }
+
+    /**
+     * <b>Effects</b>: Wake up p if parked. Other waiters will not park with
+     * keys taken before this call, but remain parked.
+     */
+    void
+    notify(parker &p)
+    {
+        ++_m_epoch;
+        if (!_m_parked_count.load()) { return; }
+
+        {
+            lock_guard<mutex> guard(_m_mtx);
+            if (!_m_unlink(p)) { return; }
+        }
+        p.unpark();
+    }
+
+    void
+    notify_one() { notify(1); }
+
+    void
+    notify_all() { notify(static_cast<std::size_t>(-1)); }
+
+    /**
+     * <b>Returns</b>: Number of parked waiters.
+     */
+    std::size_t
+    parked() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_parked_count.load(memory_order_relaxed);
+    }
+
+private:
+    bool
+    _m_enlist(parker &p, key_type key)
+    {
+        lock_guard<mutex> guard(_m_mtx);
+        // _m_parked_count should be incremented before checking epoch,
+        // see notify.
+        ++_m_parked_count;
+        if (_m_epoch.load() != key)
+        {
+            --_m_parked_count;
+            return false;
+        }
+        p.reset();
+        p._m_next = _m_parked;
+        _m_parked = &p;
+        return true;
+    }
+
+    // Must be called with _m_mtx locked.
+    bool
+    _m_unlink(parker &p) BOOST_MMM_NOEXCEPT
+    {
+        parker **link = &_m_parked;
+        while (*link && *link != &p) { link = &(*link)->_m_next; }
+        if (!*link) { return false; }
+        *link = p._m_next;
+        --_m_parked_count;
+        return true;
+    }
+
+    atomic<key_type>    _m_epoch;
+    atomic<std::size_t> _m_parked_count;
+    mutex               _m_mtx;
+    parker              *_m_parked;
+}; // class eventcount
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,152 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_INJECTION_QUEUE_HPP
+#define BOOST_MMM_DETAIL_INJECTION_QUEUE_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <boost/atomic.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Bounded lock-free multi-producer multi-consumer queue (Vyukov's algorithm).
+// Each cell carries a sequence number; producers and consumers claim a cell
+// by CAS on their own position, so they do not contend with each other unless
+// the queue is empty or full. T should be trivially copyable.
+template <typename T, typename Allocator>
+class injection_queue : private noncopyable
+{
+    struct cell_type
+    {
+        atomic<std::size_t> sequence;
+        T                   value;
+    }; // struct cell_type
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(cell_type)
+    cell_alloc_type;
+
+    // Keep positions of producers and consumers on different cache lines.
+    BOOST_STATIC_CONSTEXPR std::size_t cacheline_size = 64;
+    typedef char padding_type[cacheline_size];
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    explicit
+    injection_queue(size_type capacity)
+      : _m_mask(capacity - 1), _m_cells(cell_alloc_type().allocate(capacity))
+      , _m_enqueue_pos(0), _m_dequeue_pos(0)
+    {
+        BOOST_ASSERT(capacity && !(capacity & (capacity - 1)));
+        for (size_type i = 0; i < capacity; ++i)
+        {
+            ::new (static_cast<void *>(&_m_cells[i].sequence)) atomic<std::size_t>(i);
+        }
+    }
+
+    ~injection_queue()
+    {
+        cell_alloc_type().deallocate(_m_cells, _m_mask + 1);
+    }
+
+    /**
+     * <b>Effects</b>: Enqueue v. May be called by any thread.
+     *
+     * <b>Returns</b>: false iff the queue is full.
+     */
+    bool
+    try_push(T v)
+    {
+        cell_type *cell;
+        std::size_t pos = _m_enqueue_pos.load(memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_m_cells[pos & _m_mask];
+            const std::size_t seq = cell->sequence.load(memory_order_acquire);
+            const std::ptrdiff_t diff =
+              static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0)
+            {
+                if (_m_enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _m_enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+
+        cell->value = v;
+        cell->sequence.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Dequeue into v. May be called by any thread.
+     *
+     * <b>Returns</b>: false iff the queue is empty.
+     */
+    bool
+    try_pop(T &v)
+    {
+        cell_type *cell;
+        std::size_t pos = _m_dequeue_pos.load(memory_order_relaxed);
+        for (;;)
+        {
+            cell = &_m_cells[pos & _m_mask];
+            const std::size_t seq = cell->sequence.load(memory_order_acquire);
+            const std::ptrdiff_t diff =
+              static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff == 0)
+            {
+                if (_m_dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = _m_dequeue_pos.load(memory_order_relaxed);
+            }
+        }
+
+        v = cell->value;
+        cell->sequence.store(pos + _m_mask + 1, memory_order_release);
+        return true;
+    }
+
+private:
+    const size_type     _m_mask;
+    cell_type * const   _m_cells;
+    padding_type        _m_pad0;
+    atomic<std::size_t> _m_enqueue_pos;
+    padding_type        _m_pad1;
+    atomic<std::size_t> _m_dequeue_pos;
+    padding_type        _m_pad2;
+}; // template class injection_queue
+
+} } } // namespace boost::mmm::detail
+
+#endif
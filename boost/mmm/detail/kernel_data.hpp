@@ -0,0 +1,450 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_KERNEL_DATA_HPP
+#define BOOST_MMM_DETAIL_KERNEL_DATA_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/move/move.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/container/stable_vector.hpp>
+#include <boost/mmm/detail/thread/thread.hpp>
+
+#include <boost/mmm/detail/topology.hpp>
+#include <boost/mmm/detail/context_node.hpp>
+#include <boost/mmm/detail/eventcount.hpp>
+#include <boost/mmm/detail/work_stealing_deque.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Per kernel-thread data. Only the owner kernel may push to or pop from the
+// local deque, others may steal from it. The run-next slot holds a context
+// made runnable by the running one; the owner resumes it next, and idle
+// kernels may take it too. The mailbox holds contexts which should be
+// resumed by this kernel, only the owner may take from it.
+template <typename Context, typename Allocator>
+class kernel_data : private noncopyable
+{
+    typedef context_node<Context> node;
+    typedef typename node::pointer pointer;
+    typedef work_stealing_deque<pointer, Allocator> deque_type;
+
+    enum state_t
+    {
+        _st_dormant
+      , _st_active
+      , _st_retiring
+    }; // enum state_t
+
+public:
+    typedef std::size_t size_type;
+
+    explicit
+    kernel_data(size_type index)
+      : _m_index(index), _m_state(_st_dormant)
+      , _m_core(cpu_info::unknown), _m_node(cpu_info::unknown)
+      , _m_busy(false), _m_run_next(0), _m_handoffs(0)
+      , _m_posted(0), _m_inbox(0), _m_mailed(0) {}
+
+    ~kernel_data()
+    {
+        BOOST_ASSERT(!_m_posted.load(memory_order_relaxed) && !_m_inbox);
+    }
+
+    /**
+     * <b>Effects</b>: Mark as running a kernel-thread identified by id.
+     */
+    void
+    activate(thread::id id) BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(is_dormant());
+        _m_thread_id = id;
+        _m_state = _st_active;
+    }
+
+    /**
+     * <b>Effects</b>: Request the kernel-thread to exit after current context.
+     */
+    void
+    retire() BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(is_active());
+        _m_state = _st_retiring;
+    }
+
+    /**
+     * <b>Effects</b>: Mark as reusable after the kernel-thread is joined.
+     */
+    void
+    deactivate() BOOST_MMM_NOEXCEPT
+    {
+        BOOST_ASSERT(!local_size());
+        _m_state = _st_dormant;
+    }
+
+    bool
+    is_active() const BOOST_MMM_NOEXCEPT { return _m_state == _st_active; }
+
+    bool
+    is_dormant() const BOOST_MMM_NOEXCEPT { return _m_state == _st_dormant; }
+
+    bool
+    is_retiring() const BOOST_MMM_NOEXCEPT { return _m_state == _st_retiring; }
+
+    /**
+     * <b>Effects</b>: Record the CPU the kernel-thread is bound to.
+     */
+    void
+    locate(const cpu_info &cpu) BOOST_MMM_NOEXCEPT
+    {
+        _m_core.store(cpu.core, memory_order_relaxed);
+        _m_node.store(cpu.node, memory_order_relaxed);
+    }
+
+    /**
+     * <b>Returns</b>: 0 if other is an SMT sibling, 1 if on the same NUMA
+     * node, 2 otherwise or unknown.
+     */
+    int
+    distance(const kernel_data &other) const BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t core = _m_core.load(memory_order_relaxed);
+        const std::size_t node = _m_node.load(memory_order_relaxed);
+        if (core != cpu_info::unknown && core == other._m_core.load(memory_order_relaxed))
+        {
+            return 0;
+        }
+        if (node != cpu_info::unknown && node == other._m_node.load(memory_order_relaxed))
+        {
+            return 1;
+        }
+        return 2;
+    }
+
+    bool
+    is_located() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_node.load(memory_order_relaxed) != cpu_info::unknown
+          || _m_core.load(memory_order_relaxed) != cpu_info::unknown;
+    }
+
+    /**
+     * <b>Effects</b>: Mark whether the kernel-thread is running a context.
+     * Hint for others only.
+     */
+    void
+    set_busy(bool busy) BOOST_MMM_NOEXCEPT
+    {
+        _m_busy.store(busy, memory_order_relaxed);
+    }
+
+    bool
+    is_busy() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_busy.load(memory_order_relaxed);
+    }
+
+    thread::id
+    thread_id() const BOOST_MMM_NOEXCEPT { return _m_thread_id; }
+
+    /**
+     * <b>Returns</b>: Index of this kernel in the scheduler.
+     */
+    size_type
+    index() const BOOST_MMM_NOEXCEPT { return _m_index; }
+
+    /**
+     * <b>Effects</b>: Push ctx to local deque. Must be called by the owner.
+     */
+    void
+    push_local(BOOST_RV_REF(Context) ctx)
+    {
+        _m_deque.push(node::create(boost::move(ctx)));
+    }
+
+    /**
+     * <b>Effects</b>: Pop latest pushed context. Must be called by the owner.
+     */
+    bool
+    pop_local(Context &ctx)
+    {
+        pointer p;
+        if (!_m_deque.pop(p)) { return false; }
+        node::release(p, ctx);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Steal oldest pushed context from other kernel.
+     */
+    bool
+    steal(Context &ctx)
+    {
+        pointer p;
+        if (!_m_deque.steal(p)) { return false; }
+        node::release(p, ctx);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Store ctx to run-next slot. Must be called by the owner.
+     *
+     * <b>Returns</b>: true iff a previously stored context was displaced into
+     * displaced.
+     */
+    bool
+    put_run_next(BOOST_RV_REF(Context) ctx, Context &displaced)
+    {
+        pointer p = _m_run_next.exchange(node::create(boost::move(ctx)));
+        if (!p) { return false; }
+        node::release(p, displaced);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Take context from run-next slot. May be called by any
+     * thread.
+     */
+    bool
+    take_run_next(Context &ctx)
+    {
+        if (!_m_run_next.load(memory_order_relaxed)) { return false; }
+
+        pointer p = _m_run_next.exchange(0);
+        if (!p) { return false; }
+        node::release(p, ctx);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Post ctx to mailbox. May be called by any thread.
+     * Posted contexts are linked through their hooks, so posting allocates
+     * nothing.
+     */
+    void
+    post(BOOST_RV_REF(Context) ctx) BOOST_MMM_NOEXCEPT
+    {
+        pointer p = node::create(boost::move(ctx));
+
+        ++_m_mailed;
+        p->next = _m_posted.load(memory_order_relaxed);
+        while (!_m_posted.compare_exchange_weak(p->next, p, memory_order_release));
+    }
+
+    /**
+     * <b>Effects</b>: Take oldest posted context. Must be called by the owner,
+     * or by others after the owner exited.
+     */
+    bool
+    take_mailed(Context &ctx)
+    {
+        if (!_m_inbox)
+        {
+            if (!_m_posted.load(memory_order_relaxed)) { return false; }
+
+            // Posted ones are in LIFO order.
+            pointer p = _m_posted.exchange(0, memory_order_acquire);
+            while (p)
+            {
+                pointer next = p->next;
+                p->next = _m_inbox;
+                _m_inbox = p;
+                p = next;
+            }
+        }
+
+        pointer p = _m_inbox;
+        _m_inbox = p->next;
+        p->next = 0;
+        node::release(p, ctx);
+        --_m_mailed;
+        return true;
+    }
+
+    /**
+     * <b>Returns</b>: Number of contexts in mailbox.
+     */
+    size_type
+    mailed() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_mailed.load(memory_order_relaxed);
+    }
+
+    /**
+     * <b>Returns</b>: Number of consecutive contexts run from run-next slot or
+     * mailbox. Must be called by the owner.
+     */
+    size_type
+    handoffs() const BOOST_MMM_NOEXCEPT { return _m_handoffs; }
+
+    void
+    count_handoff() BOOST_MMM_NOEXCEPT { ++_m_handoffs; }
+
+    void
+    reset_handoffs() BOOST_MMM_NOEXCEPT { _m_handoffs = 0; }
+
+    /**
+     * <b>Returns</b>: Approximate number of contexts in local deque.
+     */
+    size_type
+    local_size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_deque.size();
+    }
+
+    /**
+     * <b>Returns</b>: Parking slot of this kernel for idle waiting.
+     */
+    parker &
+    get_parker() BOOST_MMM_NOEXCEPT { return _m_parker; }
+
+private:
+    const size_type     _m_index;
+    atomic<int>         _m_state;
+    thread::id          _m_thread_id;
+    atomic<std::size_t> _m_core;
+    atomic<std::size_t> _m_node;
+    atomic<bool>        _m_busy;
+    deque_type          _m_deque;
+    atomic<pointer>     _m_run_next;
+    size_type           _m_handoffs;
+    atomic<pointer>     _m_posted;
+    pointer             _m_inbox;
+    atomic<size_type>   _m_mailed;
+    parker              _m_parker;
+}; // template class kernel_data
+
+// Owns all kernel data ever created. Slots are reused after their
+// kernel-threads exit, and never freed until destruction. Thieves walk
+// through a published immutable snapshot, so they need no lock while others
+// add slots.
+template <typename Kernel, typename Allocator>
+class kernel_list : private noncopyable
+{
+    struct snapshot_type
+    {
+        std::size_t   size;
+        snapshot_type *retired;
+
+        Kernel **
+        kernels() BOOST_MMM_NOEXCEPT
+        {
+            return reinterpret_cast<Kernel **>(this + 1);
+        }
+    }; // struct snapshot_type
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(snapshot_type)
+    snapshot_alloc_type;
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(Kernel)
+    kernel_alloc_type;
+    typedef container::stable_vector<Kernel, kernel_alloc_type> kernels_type;
+
+    static std::size_t
+    blocks(std::size_t size) BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t bytes = sizeof(snapshot_type) + size * sizeof(Kernel *);
+        return (bytes + sizeof(snapshot_type) - 1) / sizeof(snapshot_type);
+    }
+
+    void
+    publish()
+    {
+        snapshot_type *s = snapshot_alloc_type().allocate(blocks(_m_kernels.size()));
+        s->size    = _m_kernels.size();
+        s->retired = _m_snapshot.load(memory_order_relaxed);
+        for (std::size_t i = 0; i < s->size; ++i)
+        {
+            s->kernels()[i] = &_m_kernels[i];
+        }
+        _m_snapshot.store(s, memory_order_release);
+    }
+
+public:
+    typedef std::size_t size_type;
+
+    class view
+    {
+        friend class kernel_list;
+
+        explicit
+        view(snapshot_type *s)
+          : _m_snapshot(s) {}
+
+    public:
+        size_type
+        size() const BOOST_MMM_NOEXCEPT
+        {
+            return _m_snapshot ? _m_snapshot->size : 0;
+        }
+
+        Kernel &
+        operator[](size_type n) const BOOST_MMM_NOEXCEPT
+        {
+            BOOST_ASSERT(n < size());
+            return *_m_snapshot->kernels()[n];
+        }
+
+    private:
+        snapshot_type *_m_snapshot;
+    }; // class view
+
+    kernel_list()
+      : _m_snapshot(0) {}
+
+    ~kernel_list()
+    {
+        snapshot_type *s = _m_snapshot.load(memory_order_relaxed);
+        while (s)
+        {
+            snapshot_type *retired = s->retired;
+            snapshot_alloc_type().deallocate(s, blocks(s->size));
+            s = retired;
+        }
+    }
+
+    /**
+     * <b>Effects</b>: Find a dormant slot, or create new one. Must be called
+     * with lock.
+     */
+    Kernel &
+    acquire()
+    {
+        typedef typename kernels_type::iterator iterator;
+        for (iterator itr = _m_kernels.begin(); itr != _m_kernels.end(); ++itr)
+        {
+            if (itr->is_dormant()) { return *itr; }
+        }
+
+        _m_kernels.emplace_back(_m_kernels.size());
+        publish();
+        return _m_kernels.back();
+    }
+
+    /**
+     * <b>Returns</b>: A view of all slots. May be called without lock.
+     */
+    view
+    get_view() const BOOST_MMM_NOEXCEPT
+    {
+        return view(_m_snapshot.load(memory_order_acquire));
+    }
+
+private:
+    kernels_type            _m_kernels;
+    atomic<snapshot_type *> _m_snapshot;
+}; // template class kernel_list
+
+} } } // namespace boost::mmm::detail
+
+#endif
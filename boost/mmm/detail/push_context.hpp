@@ -0,0 +1,58 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_PUSH_CONTEXT_HPP
+#define BOOST_MMM_DETAIL_PUSH_CONTEXT_HPP
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/move/move.hpp>
+#include <boost/mpl/if.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/context.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Lock-free strategies report whether the pool became non-empty.
+template <typename StrategyTraits>
+struct push_result
+  : public mpl::if_<is_lock_free<StrategyTraits>, bool, void> {};
+
+template <typename StrategyTraits, typename SchedulerTraits, typename Context>
+typename push_result<StrategyTraits>::type
+push_context(StrategyTraits strategy, SchedulerTraits traits
+, BOOST_RV_REF(Context) ctx, mpl::false_)
+{
+    return strategy.push_ctx(traits, boost::move(ctx));
+}
+
+template <typename StrategyTraits, typename SchedulerTraits, typename Context>
+typename push_result<StrategyTraits>::type
+push_context(StrategyTraits strategy, SchedulerTraits traits
+, BOOST_RV_REF(Context) ctx, mpl::true_)
+{
+    Context &c = ctx;
+    const context_attributes &attrs = fusion::at_c<4>(c);
+    const push_info info = { attrs.reason, chrono::steady_clock::now(), attrs.ran };
+    return strategy.push_ctx(traits, boost::move(c), info);
+}
+
+// Push ctx to the strategy's pool, with push_info if the strategy accepts
+// it. All of pushing should go through this.
+template <typename StrategyTraits, typename SchedulerTraits, typename Context>
+typename push_result<StrategyTraits>::type
+push_context(StrategyTraits strategy, SchedulerTraits traits, BOOST_RV_REF(Context) ctx)
+{
+    return push_context(strategy, traits, boost::move(ctx), accepts_push_info<StrategyTraits>());
+}
+
+} } } // namespace boost::mmm::detail
+
+#endif
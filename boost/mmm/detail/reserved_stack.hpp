@@ -0,0 +1,88 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_RESERVED_STACK_HPP
+#define BOOST_MMM_DETAIL_RESERVED_STACK_HPP
+
+#include <cstddef>
+#include <new>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+
+#include <boost/mmm/detail/stack_guard.hpp>
+
+#include <sys/mman.h>
+
+// Bytes of address space reserved for each stack, or 0 to allocate stacks by
+// ctx::stack_allocator. Reserved stacks are mapped with MAP_NORESERVE below a
+// guard page, so that only pages which have been touched take memory.
+#if !defined(BOOST_MMM_STACK_RESERVE)
+#   define BOOST_MMM_STACK_RESERVE 0
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+// Maps max(size, BOOST_MMM_STACK_RESERVE) bytes of stack lazily committed by
+// demand paging, with a guard page below it. Overflow onto the guard page
+// is reported by the SIGSEGV handler, see register_stack_guard.
+class reserved_stack_allocator
+{
+public:
+    /**
+     * <b>Returns</b>: Bytes of stack mapped for size, rounded up to pages.
+     */
+    static std::size_t
+    mapped_size(std::size_t size) BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t page = ctx::pagesize();
+#if BOOST_MMM_STACK_RESERVE
+        if (size < BOOST_MMM_STACK_RESERVE) { size = BOOST_MMM_STACK_RESERVE; }
+#endif
+        return (size + page - 1) / page * page;
+    }
+
+    /**
+     * <b>Returns</b>: Top of a stack which has mapped_size(size) bytes.
+     *
+     * <b>Throws</b>: std::bad_alloc if failed to map.
+     */
+    void *
+    allocate(std::size_t size) const
+    {
+        const std::size_t page = ctx::pagesize();
+        const std::size_t mapped = mapped_size(size);
+
+        void * const p = ::mmap(0, page + mapped, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED) { BOOST_THROW_EXCEPTION(std::bad_alloc()); }
+
+        if (::mprotect(p, page, PROT_NONE) != 0)
+        {
+            ::munmap(p, page + mapped);
+            BOOST_THROW_EXCEPTION(std::bad_alloc());
+        }
+        register_stack_guard(p);
+        return static_cast<char *>(p) + page + mapped;
+    }
+
+    void
+    deallocate(void *top, std::size_t size) const BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t page = ctx::pagesize();
+        const std::size_t mapped = mapped_size(size);
+
+        void * const p = static_cast<char *>(top) - mapped - page;
+        unregister_stack_guard(p);
+        ::munmap(p, page + mapped);
+    }
+}; // class reserved_stack_allocator
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,22 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_SPAWN_ATTRIBUTE_HPP
+#define BOOST_MMM_DETAIL_SPAWN_ATTRIBUTE_HPP
+
+#include <boost/mpl/bool.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Metafunction: true iff T can be passed as first argument of
+// scheduler::add_thread to set attributes of the spawned context. Models
+// should have void apply(context_tuple &) const, which is called before the
+// context is started.
+template <typename T>
+struct is_spawn_attribute : public mpl::false_ {}; // template struct is_spawn_attribute
+
+} } } // namespace boost::mmm::detail
+
+#endif
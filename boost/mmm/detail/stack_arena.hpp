@@ -0,0 +1,206 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_STACK_ARENA_HPP
+#define BOOST_MMM_DETAIL_STACK_ARENA_HPP
+
+#include <cstddef>
+#include <new>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/throw_exception.hpp>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/vector.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+
+#include <sys/mman.h>
+
+// Non-zero to carve stacks, and data of contexts placed on them, out of
+// chunks backed by huge pages instead of mapping each of them.
+#if !defined(BOOST_MMM_STACK_ARENA)
+#   define BOOST_MMM_STACK_ARENA 0
+#endif
+
+// Bytes of each chunk of the arena, should be a multiple of huge page size.
+#if !defined(BOOST_MMM_STACK_ARENA_CHUNK)
+#   define BOOST_MMM_STACK_ARENA_CHUNK (64 * 1024 * 1024)
+#endif
+
+// Non-zero to map chunks by MAP_HUGETLB from reserved huge pages. Falls back
+// to transparent huge pages if none are available.
+#if !defined(BOOST_MMM_STACK_ARENA_HUGETLB)
+#   define BOOST_MMM_STACK_ARENA_HUGETLB 0
+#endif
+
+// Non-zero to put a guard page below each stack. Guard pages split huge
+// pages, so that stacks are not guarded by default.
+#if !defined(BOOST_MMM_STACK_ARENA_GUARD)
+#   define BOOST_MMM_STACK_ARENA_GUARD 0
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+// Carves fixed-size slots for stacks out of chunks backed by huge pages, so
+// that many contexts share a few TLB entries. Freed slots are kept for later
+// ones of same size, and memory is returned to OS when the arena is
+// destroyed. Stacks larger than a chunk are mapped individually.
+class stack_arena : private noncopyable
+{
+    typedef container::flat_map<std::size_t, void *> free_lists_type;
+
+    struct chunk
+    {
+        void        *base;
+        std::size_t size;
+    }; // struct chunk
+    typedef container::vector<chunk> chunks_type;
+
+public:
+    // Alignment of chunks for transparent huge pages.
+    BOOST_STATIC_CONSTEXPR std::size_t huge_page_size = 2 * 1024 * 1024;
+
+    stack_arena()
+      : _m_top(0), _m_end(0) {}
+
+    ~stack_arena()
+    {
+        for (chunks_type::iterator itr = _m_chunks.begin(); itr != _m_chunks.end(); ++itr)
+        {
+            ::munmap(itr->base, itr->size);
+        }
+    }
+
+    /**
+     * <b>Returns</b>: Top of a stack which has size bytes at least.
+     *
+     * <b>Throws</b>: std::bad_alloc if failed to map.
+     */
+    void *
+    allocate(std::size_t size)
+    {
+        const std::size_t slot = slot_size(size);
+        if (BOOST_MMM_STACK_ARENA_CHUNK < slot) { return _m_map(slot); }
+
+        char *base;
+        {
+            lock_guard<mutex> guard(_m_mtx);
+            void *&head = _m_free[slot];
+            if (head)
+            {
+                // Freed slots are linked through their topmost word.
+                void * const top = head;
+                head = static_cast<void **>(top)[-1];
+                return top;
+            }
+
+            if (static_cast<std::size_t>(_m_end - _m_top) < slot) { _m_grow(); }
+            base = _m_top;
+            _m_top += slot;
+        }
+
+#if BOOST_MMM_STACK_ARENA_GUARD
+        ::mprotect(base, ctx::pagesize(), PROT_NONE);
+#endif
+        return base + slot;
+    }
+
+    void
+    deallocate(void *top, std::size_t size)
+    {
+        const std::size_t slot = slot_size(size);
+        if (BOOST_MMM_STACK_ARENA_CHUNK < slot)
+        {
+            ::munmap(static_cast<char *>(top) - slot, slot);
+            return;
+        }
+
+        lock_guard<mutex> guard(_m_mtx);
+        void *&head = _m_free[slot];
+        static_cast<void **>(top)[-1] = head;
+        head = top;
+    }
+
+private:
+    static std::size_t
+    slot_size(std::size_t size) BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t page = ctx::pagesize();
+#if BOOST_MMM_STACK_ARENA_GUARD
+        size += page;
+#endif
+        return (size + page - 1) / page * page;
+    }
+
+    static void *
+    _m_map(std::size_t size)
+    {
+        void * const p = ::mmap(0, size, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) { BOOST_THROW_EXCEPTION(std::bad_alloc()); }
+        return static_cast<char *>(p) + size;
+    }
+
+    // Map a new chunk and carve slots out of it, abandoning the rest of
+    // current one. Must be called with lock.
+    void
+    _m_grow()
+    {
+        const chunk c = _m_map_chunk(BOOST_MMM_STACK_ARENA_CHUNK);
+        _m_chunks.push_back(c);
+        _m_top = static_cast<char *>(c.base);
+        _m_end = _m_top + c.size;
+    }
+
+    static chunk
+    _m_map_chunk(std::size_t size)
+    {
+#if BOOST_MMM_STACK_ARENA_HUGETLB && defined(MAP_HUGETLB)
+        {
+            void * const p = ::mmap(0, size, PROT_READ | PROT_WRITE
+            , MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                const chunk c = { p, size };
+                return c;
+            }
+        }
+#endif
+        // Over-map to align to huge page, and unmap the head and tail.
+        const std::size_t mapped = size + huge_page_size;
+        void * const p = ::mmap(0, mapped, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) { BOOST_THROW_EXCEPTION(std::bad_alloc()); }
+
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(p);
+        const uintptr_t aligned = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+        const std::size_t head = aligned - begin;
+        if (head) { ::munmap(p, head); }
+        ::munmap(reinterpret_cast<void *>(aligned + size), huge_page_size - head);
+
+        void * const base = reinterpret_cast<void *>(aligned);
+#if defined(MADV_HUGEPAGE)
+        ::madvise(base, size, MADV_HUGEPAGE);
+#endif
+        const chunk c = { base, size };
+        return c;
+    }
+
+    mutex           _m_mtx;
+    // Unused range of the last chunk.
+    char            *_m_top, *_m_end;
+    free_lists_type _m_free;
+    chunks_type     _m_chunks;
+}; // class stack_arena
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,49 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_STACK_GUARD_HPP
+#define BOOST_MMM_DETAIL_STACK_GUARD_HPP
+
+#include <boost/noncopyable.hpp>
+
+#include <signal.h>
+
+namespace boost { namespace mmm { namespace detail {
+
+/**
+ * <b>Effects</b>: Register page as a guard page of a stack, so that a fault
+ * on it is reported as stack overflow of a <i>user-thread</i> and aborts.
+ * Installs the SIGSEGV handler at first.
+ *
+ * <b>Returns</b>: false iff the registry is full. The page still guards the
+ * stack, but overflow is not diagnosed.
+ */
+bool
+register_stack_guard(void *page);
+
+/**
+ * <b>Effects</b>: Unregister page registered by register_stack_guard.
+ */
+void
+unregister_stack_guard(void *page);
+
+// Alternate signal stack of a kernel-thread while alive, for the SIGSEGV
+// handler to run on overflow of the stack of a user-thread. Nothing is done
+// if the thread already has one.
+class alternate_signal_stack : private noncopyable
+{
+public:
+    alternate_signal_stack();
+
+    ~alternate_signal_stack();
+
+private:
+    void    *_m_stack;
+    stack_t _m_old;
+}; // class alternate_signal_stack
+
+} } } // namespace boost::mmm::detail
+
+#endif
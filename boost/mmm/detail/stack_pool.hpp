@@ -0,0 +1,388 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_STACK_POOL_HPP
+#define BOOST_MMM_DETAIL_STACK_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <boost/mpl/bool.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+
+#include <boost/mmm/detail/reserved_stack.hpp>
+#include <boost/mmm/detail/stack_arena.hpp>
+#include <boost/mmm/detail/stack_profiler.hpp>
+
+#include <sys/mman.h>
+
+// Number of size classes of cached stacks. Class k holds stacks of
+// ctx::minimum_stacksize() << k bytes, or BOOST_MMM_STACK_RESERVE << k bytes
+// if reserving, and larger stacks are not cached.
+#if !defined(BOOST_MMM_STACK_POOL_CLASSES)
+#   define BOOST_MMM_STACK_POOL_CLASSES 8
+#endif
+
+// Default maximum number of cached stacks for each size class. Stacks freed
+// beyond this are returned to the stack allocator.
+#if !defined(BOOST_MMM_STACK_POOL_HIGH_WATER)
+#   define BOOST_MMM_STACK_POOL_HIGH_WATER 64
+#endif
+
+// Default number of cached stacks for each size class which keep their
+// pages. Pages of others are released by madvise, but mappings are kept.
+#if !defined(BOOST_MMM_STACK_POOL_RESIDENT)
+#   define BOOST_MMM_STACK_POOL_RESIDENT 16
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+#if BOOST_MMM_STACK_RESERVE && BOOST_MMM_STACK_ARENA
+#   error BOOST_MMM_STACK_RESERVE and BOOST_MMM_STACK_ARENA are exclusive
+#elif BOOST_MMM_STACK_RESERVE
+typedef reserved_stack_allocator default_stack_allocator;
+#elif BOOST_MMM_STACK_ARENA
+typedef stack_arena default_stack_allocator;
+#else
+typedef ctx::stack_allocator default_stack_allocator;
+#endif
+
+// Stack allocator which takes stacks from Allocator, rebound to char, instead
+// of mapping them. Stacks have no guard pages.
+template <typename Allocator>
+class heap_stack_allocator
+{
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(char)
+    alloc_type;
+
+public:
+    void *
+    allocate(std::size_t size) const
+    {
+        return alloc_type().allocate(size) + size;
+    }
+
+    void
+    deallocate(void *top, std::size_t size) const
+    {
+        alloc_type().deallocate(static_cast<char *>(top) - size, size);
+    }
+}; // template class heap_stack_allocator
+
+// Stack allocator of scheduler<Strategy, Allocator>. std::allocator maps
+// stacks as configured, and others are used through heap_stack_allocator.
+template <typename Allocator>
+struct stack_allocator_of
+{
+    typedef heap_stack_allocator<Allocator> type;
+}; // template struct stack_allocator_of
+
+template <typename T>
+struct stack_allocator_of<std::allocator<T> >
+{
+    typedef default_stack_allocator type;
+}; // template struct stack_allocator_of<std::allocator>
+
+// Whether pages of cached stacks may be released by madvise. Not for the
+// arena, which would split its huge pages, nor for memory of others.
+template <typename StackAllocator>
+struct releases_pages : mpl::true_ {};
+
+template <typename Allocator>
+struct releases_pages<heap_stack_allocator<Allocator> > : mpl::false_ {};
+
+template <>
+struct releases_pages<stack_arena> : mpl::false_ {};
+
+// Caches stacks of completed contexts by size classes, so that spawning does
+// not map and unmap a stack each time. Cached stacks are linked through their
+// topmost word, which is never released.
+template <typename StackAllocator = default_stack_allocator>
+class stack_pool : private noncopyable
+{
+    struct size_class
+    {
+        mutex       mtx;
+        // Stacks which keep their pages are reused first.
+        void        *resident;
+        void        *trimmed;
+        std::size_t resident_size;
+        std::size_t trimmed_size;
+    }; // struct size_class
+
+    BOOST_STATIC_CONSTEXPR std::size_t npos = static_cast<std::size_t>(-1);
+
+    typedef StackAllocator stack_allocator_type;
+
+public:
+    stack_pool()
+      : _m_base(base_size(static_cast<stack_allocator_type *>(0)))
+      , _m_high_water(BOOST_MMM_STACK_POOL_HIGH_WATER)
+      , _m_resident(BOOST_MMM_STACK_POOL_RESIDENT)
+    {
+        for (std::size_t k = 0; k < BOOST_MMM_STACK_POOL_CLASSES; ++k)
+        {
+            size_class &c = _m_classes[k];
+            c.resident = c.trimmed = 0;
+            c.resident_size = c.trimmed_size = 0;
+        }
+    }
+
+    ~stack_pool()
+    {
+        for (std::size_t k = 0; k < BOOST_MMM_STACK_POOL_CLASSES; ++k)
+        {
+            _m_shrink(k, 0, 0);
+        }
+    }
+
+    /**
+     * <b>Returns</b>: Top of a stack which has size bytes at least.
+     */
+    void *
+    allocate(std::size_t size)
+    {
+        const std::size_t k = _m_class_of(size);
+        if (k == npos) { return _m_alloc.allocate(size); }
+
+        size_class &c = _m_classes[k];
+        {
+            lock_guard<mutex> guard(c.mtx);
+            if (void *top = pop(c.resident, c.resident_size)) { return top; }
+            if (void *top = pop(c.trimmed, c.trimmed_size)) { return top; }
+        }
+        return _m_alloc.allocate(_m_base << k);
+    }
+
+    /**
+     * <b>Precondition</b>: top is allocated by allocate(size).
+     *
+     * <b>Effects</b>: Cache the stack, or free it if the class has high water
+     * mark of stacks.
+     */
+    void
+    deallocate(void *top, std::size_t size)
+    {
+        const std::size_t k = _m_class_of(size);
+        if (k == npos) { _m_alloc.deallocate(top, size); return; }
+
+        size_class &c = _m_classes[k];
+        const std::size_t high_water = _m_high_water.load(memory_order_relaxed);
+        {
+            lock_guard<mutex> guard(c.mtx);
+            if (c.resident_size + c.trimmed_size < high_water
+             && c.resident_size < _m_resident.load(memory_order_relaxed))
+            {
+                push(c.resident, c.resident_size, top);
+                return;
+            }
+        }
+
+        // Not to call madvise with lock.
+        release_pages(top, _m_base << k);
+        {
+            lock_guard<mutex> guard(c.mtx);
+            if (c.resident_size + c.trimmed_size < high_water)
+            {
+                push(c.trimmed, c.trimmed_size, top);
+                return;
+            }
+        }
+        _m_alloc.deallocate(top, _m_base << k);
+    }
+
+    /**
+     * <b>Effects</b>: Cache at most high_water stacks for each size class,
+     * and keep pages of at most resident ones of them. Excess ones are freed
+     * or released immediately.
+     */
+    void
+    set_limits(std::size_t high_water, std::size_t resident)
+    {
+        _m_high_water.store(high_water, memory_order_relaxed);
+        _m_resident.store(resident, memory_order_relaxed);
+        for (std::size_t k = 0; k < BOOST_MMM_STACK_POOL_CLASSES; ++k)
+        {
+            _m_shrink(k, high_water, resident);
+        }
+    }
+
+    /**
+     * <b>Effects</b>: Release pages of all of cached stacks, e.g. under
+     * memory pressure. Their mappings are kept.
+     */
+    void
+    trim()
+    {
+        for (std::size_t k = 0; k < BOOST_MMM_STACK_POOL_CLASSES; ++k)
+        {
+            _m_shrink(k, npos, 0);
+        }
+    }
+
+private:
+    // Size of class 0.
+    template <typename A>
+    static std::size_t
+    base_size(const A *) BOOST_MMM_NOEXCEPT
+    {
+        return ctx::minimum_stacksize();
+    }
+
+#if BOOST_MMM_STACK_RESERVE
+    static std::size_t
+    base_size(const reserved_stack_allocator *) BOOST_MMM_NOEXCEPT
+    {
+        return reserved_stack_allocator::mapped_size(BOOST_MMM_STACK_RESERVE);
+    }
+#endif
+
+    // Returns npos if size should not be cached.
+    std::size_t
+    _m_class_of(std::size_t size) const BOOST_MMM_NOEXCEPT
+    {
+        for (std::size_t k = 0; k < BOOST_MMM_STACK_POOL_CLASSES; ++k)
+        {
+            if (size <= (_m_base << k)) { return k; }
+        }
+        return npos;
+    }
+
+    // Free stacks of class k beyond high_water, and release pages of
+    // resident ones beyond resident.
+    void
+    _m_shrink(std::size_t k, std::size_t high_water, std::size_t resident)
+    {
+        size_class &c = _m_classes[k];
+        const std::size_t size = _m_base << k;
+
+        void *freed = 0, *released = 0;
+        std::size_t n_freed = 0, n_released = 0;
+        {
+            lock_guard<mutex> guard(c.mtx);
+            while (high_water < c.resident_size + c.trimmed_size)
+            {
+                void *top = pop(c.trimmed, c.trimmed_size);
+                if (!top) { top = pop(c.resident, c.resident_size); }
+                push(freed, n_freed, top);
+            }
+            while (resident < c.resident_size)
+            {
+                push(released, n_released, pop(c.resident, c.resident_size));
+            }
+        }
+
+        while (void *top = pop(freed, n_freed)) { _m_alloc.deallocate(top, size); }
+        if (!released) { return; }
+
+        void *last = released;
+        for (void *top = released; top; top = next_of(top))
+        {
+            release_pages(top, size);
+            last = top;
+        }
+        lock_guard<mutex> guard(c.mtx);
+        next_of(last) = c.trimmed;
+        c.trimmed = released;
+        c.trimmed_size += n_released;
+    }
+
+    static void *&
+    next_of(void *top) BOOST_MMM_NOEXCEPT
+    {
+        return static_cast<void **>(top)[-1];
+    }
+
+    static void
+    push(void *&head, std::size_t &size, void *top) BOOST_MMM_NOEXCEPT
+    {
+        next_of(top) = head;
+        head = top;
+        ++size;
+    }
+
+    static void *
+    pop(void *&head, std::size_t &size) BOOST_MMM_NOEXCEPT
+    {
+        void *top = head;
+        if (top)
+        {
+            head = next_of(top);
+            --size;
+        }
+        return top;
+    }
+
+    // Release pages of a stack to OS except its topmost page, which has the
+    // link. The range is rounded inward to pages.
+    static void
+    release_pages(void *top, std::size_t size) BOOST_MMM_NOEXCEPT
+    {
+        if (!releases_pages<stack_allocator_type>::value) { return; }
+
+        const uintptr_t page = ctx::pagesize();
+        const uintptr_t end = reinterpret_cast<uintptr_t>(&next_of(top)) & ~(page - 1);
+        const uintptr_t begin =
+          (reinterpret_cast<uintptr_t>(top) - size + page - 1) & ~(page - 1);
+        if (end <= begin) { return; }
+
+        void * const addr = reinterpret_cast<void *>(begin);
+#if defined(MADV_FREE)
+        // Falls back if the kernel does not support.
+        if (::madvise(addr, end - begin, MADV_FREE) == 0) { return; }
+#endif
+        ::madvise(addr, end - begin, MADV_DONTNEED);
+    }
+
+    const std::size_t    _m_base;
+    atomic<std::size_t>  _m_high_water;
+    atomic<std::size_t>  _m_resident;
+    stack_allocator_type _m_alloc;
+    size_class           _m_classes[BOOST_MMM_STACK_POOL_CLASSES];
+}; // template class stack_pool
+
+// Stack allocator for contexts, which takes stacks from pool. Stacks are
+// filled with stack_canary if canary, to measure usage of them.
+template <typename StackPool>
+class pooled_stack_allocator
+{
+public:
+    explicit
+    pooled_stack_allocator(StackPool &pool, bool canary = false) BOOST_MMM_NOEXCEPT
+      : _m_pool(&pool), _m_canary(canary) {}
+
+    void *
+    allocate(std::size_t size) const
+    {
+        void * const top = _m_pool->allocate(size);
+        if (_m_canary) { fill_stack_canary(static_cast<char *>(top) - size, size); }
+        return top;
+    }
+
+    void
+    deallocate(void *top, std::size_t size) const
+    {
+        _m_pool->deallocate(top, size);
+    }
+
+private:
+    StackPool *_m_pool;
+    bool      _m_canary;
+}; // template class pooled_stack_allocator
+
+} } } // namespace boost::mmm::detail
+
+#endif
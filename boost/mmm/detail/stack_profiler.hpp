@@ -0,0 +1,164 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_STACK_PROFILER_HPP
+#define BOOST_MMM_DETAIL_STACK_PROFILER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <typeinfo>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/noncopyable.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+
+#include <boost/mmm/stack_profile.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Byte which unused stack is filled with while profiling.
+BOOST_STATIC_CONSTEXPR unsigned char stack_canary = 0xc5;
+
+// Fill [limit, limit + size) with stack_canary.
+inline void
+fill_stack_canary(void *limit, std::size_t size) BOOST_MMM_NOEXCEPT
+{
+    std::memset(limit, stack_canary, size);
+}
+
+// Returns bytes of [limit, base) which have been written, that is, from the
+// lowest byte which is not stack_canary to base.
+inline std::size_t
+used_stack(const void *limit, const void *base) BOOST_MMM_NOEXCEPT
+{
+    const unsigned char *p = static_cast<const unsigned char *>(limit);
+    const unsigned char * const end = static_cast<const unsigned char *>(base);
+    while (p != end && *p == stack_canary) { ++p; }
+    return end - p;
+}
+
+// Identifies entry functions of contexts; address of a function, or type of
+// a function object.
+template <typename Fn>
+inline const void *
+entry_of(Fn *fn) BOOST_MMM_NOEXCEPT
+{
+    return reinterpret_cast<const void *>(fn);
+}
+
+template <typename Fn>
+inline const void *
+entry_of(const Fn &) BOOST_MMM_NOEXCEPT
+{
+    return &typeid(Fn);
+}
+
+// Stack usage of completed contexts for each entry function.
+class stack_profiler : private noncopyable
+{
+    typedef std::size_t size_type;
+
+    struct record
+    {
+        size_type samples;
+        size_type max_used;
+        size_type total_used;
+    }; // struct record
+    typedef container::flat_map<const void *, record> records_type;
+
+public:
+    stack_profiler()
+      : _m_enabled(false) {}
+
+    void
+    enable(const stack_sizing_policy &policy)
+    {
+        lock_guard<mutex> guard(_m_mtx);
+        _m_policy = policy;
+        _m_enabled.store(true, memory_order_relaxed);
+    }
+
+    void
+    disable()
+    {
+        _m_enabled.store(false, memory_order_relaxed);
+    }
+
+    bool
+    enabled() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_enabled.load(memory_order_relaxed);
+    }
+
+    void
+    record_usage(const void *entry, size_type used)
+    {
+        lock_guard<mutex> guard(_m_mtx);
+        record &r = _m_records[entry];
+        ++r.samples;
+        if (r.max_used < used) { r.max_used = used; }
+        r.total_used += used;
+    }
+
+    /**
+     * <b>Returns</b>: Stack size for a context of entry, or size if not
+     * enough samples have been recorded.
+     */
+    size_type
+    size_for(const void *entry, size_type size) const
+    {
+        lock_guard<mutex> guard(_m_mtx);
+        records_type::const_iterator itr = _m_records.find(entry);
+        if (itr == _m_records.end()) { return size; }
+        return _m_size_for(itr->second, size);
+    }
+
+    stack_profile
+    profile_of(const void *entry, size_type size) const
+    {
+        stack_profile profile = { 0, 0, 0, size };
+
+        lock_guard<mutex> guard(_m_mtx);
+        records_type::const_iterator itr = _m_records.find(entry);
+        if (itr == _m_records.end()) { return profile; }
+
+        const record &r = itr->second;
+        profile.samples    = r.samples;
+        profile.max_used   = r.max_used;
+        profile.mean_used  = r.total_used / r.samples;
+        profile.stack_size = _m_size_for(r, size);
+        return profile;
+    }
+
+private:
+    // Must be called with lock.
+    size_type
+    _m_size_for(const record &r, size_type size) const BOOST_MMM_NOEXCEPT
+    {
+        if (!_m_policy.min_samples || r.samples < _m_policy.min_samples) { return size; }
+
+        const size_type page = ctx::pagesize();
+        size_type sized = r.max_used + r.max_used / 100 * _m_policy.headroom;
+        sized = (sized + page - 1) / page * page;
+        if (sized < _m_policy.min_size) { sized = _m_policy.min_size; }
+        if (_m_policy.max_size < sized) { sized = _m_policy.max_size; }
+        return sized;
+    }
+
+    mutable mutex       _m_mtx;
+    atomic<bool>        _m_enabled;
+    stack_sizing_policy _m_policy;
+    records_type        _m_records;
+}; // class stack_profiler
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,118 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_STACK_UTILS_HPP
+#define BOOST_MMM_DETAIL_STACK_UTILS_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/mmm/detail/context_switch.hpp>
+
+#if BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT
+#   include <boost/context/stack_allocator.hpp>
+#   include <boost/context/stack_utils.hpp>
+#else
+#   include <new>
+#   include <boost/assert.hpp>
+#   include <boost/throw_exception.hpp>
+#   include <signal.h>
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   include <sys/resource.h>
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+// Stack allocator and stack sizes. Only trunk Boost.Context provides them
+// along with its fcontext, so others use ones of the system instead.
+namespace ctx {
+
+#if BOOST_MMM_CONTEXT_SWITCH == BOOST_MMM_CONTEXT_SWITCH_TRUNK_FCONTEXT
+
+using ::boost::ctx::stack_allocator;
+using ::boost::ctx::default_stacksize;
+using ::boost::ctx::minimum_stacksize;
+using ::boost::ctx::maximum_stacksize;
+using ::boost::ctx::pagesize;
+
+#else
+
+inline std::size_t
+pagesize()
+{
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+inline std::size_t
+page_round_up(std::size_t size)
+{
+    const std::size_t page = pagesize();
+    return (size + page - 1) / page * page;
+}
+
+// Enough for signal handlers, and a power of 2 as sizes of stack_pool are
+// multiples of this.
+inline std::size_t
+minimum_stacksize()
+{
+    std::size_t size = pagesize();
+    while (size < static_cast<std::size_t>(SIGSTKSZ)) { size <<= 1; }
+    return size;
+}
+
+// Soft limit of stacks of processes, or 8 MiB if unlimited.
+inline std::size_t
+maximum_stacksize()
+{
+    ::rlimit limit;
+    if (::getrlimit(RLIMIT_STACK, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY)
+    {
+        return 8 * 1024 * 1024;
+    }
+    return static_cast<std::size_t>(limit.rlim_cur);
+}
+
+// Same as trunk Boost.Context.
+inline std::size_t
+default_stacksize()
+{
+    const std::size_t size = 256 * 1024;
+    const std::size_t max = maximum_stacksize();
+    return size < max ? size : max;
+}
+
+// Maps stacks with a guard page below, and returns their tops as
+// ::boost::ctx::stack_allocator.
+struct stack_allocator
+{
+    void *
+    allocate(std::size_t size) const
+    {
+        BOOST_ASSERT(minimum_stacksize() <= size);
+        const std::size_t mapped = page_round_up(size) + pagesize();
+        void * const limit = ::mmap(0, mapped, PROT_READ | PROT_WRITE
+        , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (limit == MAP_FAILED) { BOOST_THROW_EXCEPTION(std::bad_alloc()); }
+        ::mprotect(limit, pagesize(), PROT_NONE);
+        return static_cast<char *>(limit) + mapped;
+    }
+
+    void
+    deallocate(void *top, std::size_t size) const
+    {
+        const std::size_t mapped = page_round_up(size) + pagesize();
+        ::munmap(static_cast<char *>(top) - mapped, mapped);
+    }
+}; // struct stack_allocator
+
+#endif
+
+} // namespace boost::mmm::detail::ctx
+
+} } } // namespace boost::mmm::detail
+
+#endif // BOOST_MMM_DETAIL_STACK_UTILS_HPP
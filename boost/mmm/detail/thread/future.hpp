@@ -11,6 +11,11 @@
 
 #include <boost/thread/future.hpp>
 
+// Promises take allocators of their shared states.
+#if defined(BOOST_THREAD_FUTURE_USES_ALLOCATORS)
+#   define BOOST_MMM_THREAD_FUTURE_USES_ALLOCATORS
+#endif
+
 #include <boost/move/move.hpp>
 
 namespace boost { namespace mmm {
@@ -0,0 +1,294 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_TIMER_WHEEL_HPP
+#define BOOST_MMM_DETAIL_TIMER_WHEEL_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/cstdint.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <boost/move/move.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Hashed timing wheel of suspended contexts. A context is linked into the slot
+// of its expiry tick modulo the number of slots through its hook, so insert()
+// and cancel() are O(1) and allocate nothing; a slot may hold contexts of
+// later revolutions, which are skipped while expiring. Deadlines are rounded
+// up to the tick, thus no context expires early.
+template <typename Context, typename Allocator>
+class timer_wheel : private noncopyable
+{
+public:
+    typedef chrono::steady_clock          clock_type;
+    typedef clock_type::time_point        time_point;
+    typedef clock_type::duration          duration;
+    typedef std::size_t                   size_type;
+
+private:
+    typedef boost::uint64_t tick_type;
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(context_hook *)
+    slot_alloc_type;
+
+    tick_type
+    floor_tick(const time_point &tp) const BOOST_MMM_NOEXCEPT
+    {
+        if (tp <= _m_epoch) { return 0; }
+        return static_cast<tick_type>((tp - _m_epoch) / _m_resolution);
+    }
+
+    tick_type
+    ceil_tick(const time_point &tp) const BOOST_MMM_NOEXCEPT
+    {
+        if (tp <= _m_epoch) { return 0; }
+        return static_cast<tick_type>((tp - _m_epoch + _m_resolution - duration(1)) / _m_resolution);
+    }
+
+    time_point
+    tick_time(tick_type tick) const BOOST_MMM_NOEXCEPT
+    {
+        return _m_epoch + _m_resolution * static_cast<duration::rep>(tick);
+    }
+
+    static void
+    unlink(context_hook *hook) BOOST_MMM_NOEXCEPT
+    {
+        *hook->timer_link = hook->timer_next;
+        if (hook->timer_next) { hook->timer_next->timer_link = hook->timer_link; }
+        hook->timer_link = 0;
+    }
+
+public:
+    // List of expired contexts, handed over by expire().
+    class expired_list : private noncopyable
+    {
+        friend class timer_wheel;
+
+    public:
+        expired_list()
+          : _m_head(0) {}
+
+        ~expired_list()
+        {
+            BOOST_ASSERT(!_m_head);
+        }
+
+        /**
+         * <b>Effects</b>: Take the hook of the first expired context out.
+         *
+         * <b>Returns</b>: 0 iff no context remains.
+         */
+        context_hook *
+        pop_hook() BOOST_MMM_NOEXCEPT
+        {
+            context_hook * const hook = _m_head;
+            if (hook) { _m_head = hook->timer_next; }
+            return hook;
+        }
+
+        /**
+         * <b>Effects</b>: Move the first expired context into ctx.
+         *
+         * <b>Returns</b>: false iff no context remains.
+         */
+        bool
+        pop(Context &ctx) BOOST_MMM_NOEXCEPT
+        {
+            context_hook * const hook = pop_hook();
+            if (!hook) { return false; }
+            ctx.unpark(hook);
+            return true;
+        }
+
+    private:
+        context_hook *_m_head;
+    }; // class expired_list
+
+    /**
+     * <b>Requires</b>: slots is a power of 2.
+     */
+    timer_wheel(duration resolution, size_type slots)
+      : _m_epoch(clock_type::now()), _m_resolution(resolution)
+      , _m_mask(slots - 1), _m_slots(slot_alloc_type().allocate(slots))
+      , _m_current(0), _m_size(0)
+    {
+        BOOST_ASSERT(resolution > duration::zero());
+        BOOST_ASSERT(slots && !(slots & (slots - 1)));
+        for (size_type i = 0; i < slots; ++i) { _m_slots[i] = 0; }
+    }
+
+    ~timer_wheel()
+    {
+        BOOST_ASSERT(!_m_size.load());
+        slot_alloc_type().deallocate(_m_slots, _m_mask + 1);
+    }
+
+    /**
+     * <b>Effects</b>: Suspend ctx until deadline. May be called by any thread.
+     */
+    void
+    insert(BOOST_RV_REF(Context) ctx, const time_point &deadline)
+    {
+        insert_hook(static_cast<Context &>(ctx).park(), deadline);
+    }
+
+    /**
+     * <b>Requires</b>: hook is not linked to any timer_wheel.
+     *
+     * <b>Effects</b>: Link hook of a parked context until deadline, or until
+     * cancel(). May be called by any thread.
+     */
+    void
+    insert_hook(context_hook *hook, const time_point &deadline)
+    {
+        BOOST_ASSERT(!hook->timer_link);
+        tick_type expiry = ceil_tick(deadline);
+
+        lock_guard<mutex> guard(_m_mtx);
+        const tick_type current = _m_current.load(memory_order_relaxed);
+        if (expiry <= current) { expiry = current + 1; }
+
+        context_hook *&slot = _m_slots[expiry & _m_mask];
+        hook->timer_expiry = expiry;
+        hook->timer_next   = slot;
+        hook->timer_link   = &slot;
+        if (slot) { slot->timer_link = &hook->timer_next; }
+        slot = hook;
+        _m_size.fetch_add(1, memory_order_release);
+    }
+
+    /**
+     * <b>Effects</b>: Unlink hook unless it has expired already. May be
+     * called by any thread.
+     *
+     * <b>Returns</b>: true iff hook was unlinked, and then the caller owns it.
+     */
+    bool
+    cancel(context_hook *hook)
+    {
+        lock_guard<mutex> guard(_m_mtx);
+        if (!hook->timer_link) { return false; }
+        unlink(hook);
+        _m_size.fetch_sub(1, memory_order_release);
+        return true;
+    }
+
+    /**
+     * <b>Effects</b>: Move contexts whose deadline is before now into
+     * expired. Returns immediately if other thread is expiring.
+     *
+     * <b>Returns</b>: Number of expired contexts.
+     */
+    size_type
+    expire(const time_point &now, expired_list &expired)
+    {
+        BOOST_ASSERT(!expired._m_head);
+
+        const tick_type target = floor_tick(now);
+        if (!_m_size.load(memory_order_acquire)
+         || target <= _m_current.load(memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        unique_lock<mutex> guard(_m_mtx, try_to_lock);
+        if (!guard.owns_lock()) { return 0; }
+
+        tick_type tick = _m_current.load(memory_order_relaxed);
+        // Visit each slot once at most, even if ticks behind more than a
+        // revolution.
+        const tick_type last = (target - tick > _m_mask) ? tick + _m_mask + 1 : target;
+
+        size_type count = 0;
+        while (tick++ != last)
+        {
+            for (context_hook *hook = _m_slots[tick & _m_mask]; hook;)
+            {
+                context_hook * const next = hook->timer_next;
+                if (hook->timer_expiry <= target)
+                {
+                    unlink(hook);
+                    hook->timer_next = expired._m_head;
+                    expired._m_head = hook;
+                    ++count;
+                }
+                hook = next;
+            }
+        }
+
+        _m_current.store(target, memory_order_relaxed);
+        _m_size.fetch_sub(count, memory_order_release);
+        return count;
+    }
+
+    /**
+     * <b>Effects</b>: Store the time until which no context will expire into
+     * tp. It might be earlier than the actual earliest deadline, to bound the
+     * number of slots to be scanned.
+     *
+     * <b>Returns</b>: false iff no context is suspended.
+     */
+    bool
+    next_expiry(time_point &tp)
+    {
+        if (!_m_size.load(memory_order_acquire)) { return false; }
+
+        lock_guard<mutex> guard(_m_mtx);
+        if (!_m_size.load(memory_order_relaxed)) { return false; }
+
+        const tick_type current = _m_current.load(memory_order_relaxed);
+        for (tick_type tick = current + 1; tick <= current + _m_mask + 1; ++tick)
+        {
+            for (context_hook *hook = _m_slots[tick & _m_mask]; hook; hook = hook->timer_next)
+            {
+                if (hook->timer_expiry <= tick)
+                {
+                    tp = tick_time(tick);
+                    return true;
+                }
+            }
+        }
+
+        // All of contexts will expire after a revolution.
+        tp = tick_time(current + _m_mask + 1);
+        return true;
+    }
+
+    /**
+     * <b>Returns</b>: Number of suspended contexts.
+     */
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_size.load(memory_order_relaxed);
+    }
+
+private:
+    const time_point  _m_epoch;
+    const duration    _m_resolution;
+    const size_type   _m_mask;
+    context_hook ** const _m_slots;
+    atomic<tick_type> _m_current;
+    atomic<size_type> _m_size;
+    mutex             _m_mtx;
+}; // template class timer_wheel
+
+} } } // namespace boost::mmm::detail
+
+#endif
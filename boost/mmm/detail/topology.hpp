@@ -0,0 +1,49 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_TOPOLOGY_HPP
+#define BOOST_MMM_DETAIL_TOPOLOGY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/thread/thread.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+struct cpu_info
+{
+    BOOST_STATIC_CONSTEXPR std::size_t unknown = static_cast<std::size_t>(-1);
+
+    std::size_t cpu;
+    // Smallest CPU number among SMT siblings, identifies a physical core.
+    std::size_t core;
+    std::size_t node;
+}; // struct cpu_info
+
+/**
+ * <b>Effects</b>: Read online CPUs from /sys, ordered so that consecutive
+ * ones share a NUMA node and distinct physical cores come before their SMT
+ * siblings. CPUs not in allowed are skipped unless allowed is empty.
+ *
+ * <b>Returns</b>: false iff topology is not available on this platform.
+ */
+bool
+read_cpu_topology(const std::vector<std::size_t> &allowed, std::vector<cpu_info> &cpus);
+
+/**
+ * <b>Effects</b>: Restrict th to run only on cpu.
+ *
+ * <b>Returns</b>: false iff failed or not supported.
+ */
+bool
+bind_to_cpu(boost::thread &th, std::size_t cpu);
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,207 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_DETAIL_WORK_STEALING_DEQUE_HPP
+#define BOOST_MMM_DETAIL_WORK_STEALING_DEQUE_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <boost/atomic.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+// Chase-Lev work stealing deque. Only the owner thread may call push() and
+// pop() (LIFO end), any thread may call steal() (FIFO end). T should be
+// trivially copyable, typically a pointer.
+//
+// Grown arrays are not freed until destruction because thieves might still
+// read from them; the total wasted memory is bounded by the last array size.
+template <typename T, typename Allocator>
+class work_stealing_deque : private noncopyable
+{
+    typedef std::ptrdiff_t index_type;
+
+    struct array_type
+    {
+        std::size_t capacity;
+        array_type  *retired;
+
+        atomic<T> *
+        elems() BOOST_MMM_NOEXCEPT
+        {
+            return reinterpret_cast<atomic<T> *>(this + 1);
+        }
+
+        T
+        get(index_type i) BOOST_MMM_NOEXCEPT
+        {
+            return elems()[i & (capacity - 1)].load(memory_order_relaxed);
+        }
+
+        void
+        put(index_type i, T v) BOOST_MMM_NOEXCEPT
+        {
+            elems()[i & (capacity - 1)].store(v, memory_order_relaxed);
+        }
+    }; // struct array_type
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(array_type)
+    array_alloc_type;
+
+    static std::size_t
+    blocks(std::size_t capacity) BOOST_MMM_NOEXCEPT
+    {
+        const std::size_t bytes = sizeof(array_type) + capacity * sizeof(atomic<T>);
+        return (bytes + sizeof(array_type) - 1) / sizeof(array_type);
+    }
+
+    array_type *
+    allocate(std::size_t capacity)
+    {
+        BOOST_ASSERT(capacity && !(capacity & (capacity - 1)));
+
+        array_type *a = array_alloc_type().allocate(blocks(capacity));
+        a->capacity = capacity;
+        a->retired  = 0;
+        for (std::size_t i = 0; i < capacity; ++i)
+        {
+            ::new (static_cast<void *>(a->elems() + i)) atomic<T>();
+        }
+        return a;
+    }
+
+    static void
+    deallocate(array_type *a) BOOST_MMM_NOEXCEPT
+    {
+        array_alloc_type().deallocate(a, blocks(a->capacity));
+    }
+
+    array_type *
+    grow(array_type *a, index_type top, index_type bottom)
+    {
+        array_type *n = allocate(a->capacity * 2);
+        for (index_type i = top; i < bottom; ++i)
+        {
+            n->put(i, a->get(i));
+        }
+        n->retired = a;
+        _m_array.store(n, memory_order_release);
+        return n;
+    }
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+    explicit
+    work_stealing_deque(size_type capacity = 64)
+      : _m_top(0), _m_bottom(0), _m_array(allocate(capacity)) {}
+
+    ~work_stealing_deque()
+    {
+        array_type *a = _m_array.load(memory_order_relaxed);
+        while (a)
+        {
+            array_type *retired = a->retired;
+            deallocate(a);
+            a = retired;
+        }
+    }
+
+    /**
+     * <b>Effects</b>: Push v to bottom. Must be called by the owner.
+     */
+    void
+    push(T v)
+    {
+        const index_type b = _m_bottom.load(memory_order_relaxed);
+        const index_type t = _m_top.load(memory_order_acquire);
+        array_type *a = _m_array.load(memory_order_relaxed);
+
+        if (static_cast<index_type>(a->capacity) - 1 < b - t)
+        {
+            a = grow(a, t, b);
+        }
+        a->put(b, v);
+        atomic_thread_fence(memory_order_release);
+        _m_bottom.store(b + 1, memory_order_relaxed);
+    }
+
+    /**
+     * <b>Effects</b>: Pop from bottom. Must be called by the owner.
+     *
+     * <b>Returns</b>: true iff an element was taken into v.
+     */
+    bool
+    pop(T &v)
+    {
+        const index_type b = _m_bottom.load(memory_order_relaxed) - 1;
+        array_type *a = _m_array.load(memory_order_relaxed);
+        _m_bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        index_type t = _m_top.load(memory_order_relaxed);
+
+        if (b < t)
+        {
+            _m_bottom.store(b + 1, memory_order_relaxed);
+            return false;
+        }
+
+        v = a->get(b);
+        if (t != b) { return true; }
+
+        // Last one element, race against thieves.
+        const bool won = _m_top.compare_exchange_strong(
+          t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+        _m_bottom.store(b + 1, memory_order_relaxed);
+        return won;
+    }
+
+    /**
+     * <b>Effects</b>: Steal from top. May be called by any thread.
+     *
+     * <b>Returns</b>: true iff an element was taken into v.
+     */
+    bool
+    steal(T &v)
+    {
+        index_type t = _m_top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        const index_type b = _m_bottom.load(memory_order_acquire);
+
+        if (!(t < b)) { return false; }
+
+        array_type *a = _m_array.load(memory_order_acquire);
+        v = a->get(t);
+        return _m_top.compare_exchange_strong(
+          t, t + 1, memory_order_seq_cst, memory_order_relaxed);
+    }
+
+    /**
+     * <b>Returns</b>: Approximate number of elements.
+     */
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        const index_type b = _m_bottom.load(memory_order_relaxed);
+        const index_type t = _m_top.load(memory_order_relaxed);
+        return t < b ? static_cast<size_type>(b - t) : 0;
+    }
+
+private:
+    atomic<index_type>   _m_top;
+    atomic<index_type>   _m_bottom;
+    atomic<array_type *> _m_array;
+}; // template class work_stealing_deque
+
+} } } // namespace boost::mmm::detail
+
+#endif
@@ -0,0 +1,134 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_FUTURE_GROUP_HPP
+#define BOOST_MMM_FUTURE_GROUP_HPP
+
+#include <memory>
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/move/move.hpp>
+#include <boost/utility/swap.hpp>
+
+#include <boost/container/stable_vector.hpp>
+#include <boost/mmm/detail/thread/future.hpp>
+
+namespace boost { namespace mmm {
+
+template <typename Strategy, typename Allocator>
+class scheduler;
+
+/**
+ * Futures of <i>user-threads</i> which are added at once by
+ * scheduler::add_threads. The order of futures is same as spawning order.
+ */
+template <typename R, typename Allocator = std::allocator<void> >
+class future_group
+{
+    BOOST_MOVABLE_BUT_NOT_COPYABLE(future_group)
+
+public:
+    typedef BOOST_MMM_THREAD_FUTURE<R> future_type;
+
+private:
+    typedef
+      container::stable_vector<
+        future_type
+      , typename BOOST_MMM_ALLOCATOR_REBIND(Allocator)(future_type)>
+    futures_type;
+
+    template <typename, typename>
+    friend class scheduler;
+
+    void
+    push_back(BOOST_RV_REF(future_type) f)
+    {
+        _m_futures.push_back(boost::move(f));
+    }
+
+public:
+    typedef typename futures_type::size_type      size_type;
+    typedef typename futures_type::iterator       iterator;
+    typedef typename futures_type::const_iterator const_iterator;
+
+    future_group() {}
+
+    future_group(BOOST_RV_REF(future_group) other)
+      : _m_futures(boost::move(other._m_futures)) {}
+
+    future_group &
+    operator=(BOOST_RV_REF(future_group) other)
+    {
+        future_group(boost::move(other)).swap(*this);
+        return *this;
+    }
+
+    /**
+     * <b>Effects</b>: Wait until all <i>user-threads</i> are completed.
+     */
+    void
+    wait() const
+    {
+        for (const_iterator itr = begin(); itr != end(); ++itr)
+        {
+            itr->wait();
+        }
+    }
+
+    size_type
+    size() const BOOST_MMM_NOEXCEPT { return _m_futures.size(); }
+
+    bool
+    empty() const BOOST_MMM_NOEXCEPT { return _m_futures.empty(); }
+
+    future_type &
+    operator[](size_type n)
+    {
+        BOOST_ASSERT(n < size());
+        return _m_futures[n];
+    }
+
+    const future_type &
+    operator[](size_type n) const
+    {
+        BOOST_ASSERT(n < size());
+        return _m_futures[n];
+    }
+
+    iterator
+    begin() { return _m_futures.begin(); }
+
+    const_iterator
+    begin() const { return _m_futures.begin(); }
+
+    iterator
+    end() { return _m_futures.end(); }
+
+    const_iterator
+    end() const { return _m_futures.end(); }
+
+    void
+    swap(future_group &other)
+    {
+        _m_futures.swap(other._m_futures);
+    }
+
+private:
+    futures_type _m_futures;
+}; // template class future_group
+
+template <typename R, typename A>
+inline void
+swap(future_group<R, A> &l, future_group<R, A> &r)
+{
+    l.swap(r);
+}
+
+} } // namespace boost::mmm
+
+#endif
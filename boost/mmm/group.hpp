@@ -0,0 +1,75 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_GROUP_HPP
+#define BOOST_MMM_GROUP_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mpl/bool.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/current_context.hpp>
+#include <boost/mmm/detail/spawn_attribute.hpp>
+
+#include <boost/fusion/include/at.hpp>
+
+namespace boost { namespace mmm {
+
+namespace detail {
+
+struct group_attribute
+{
+    void
+    apply(context_tuple &ctx) const BOOST_MMM_NOEXCEPT
+    {
+        fusion::at_c<4>(ctx).group = group;
+    }
+
+    std::size_t group;
+}; // struct group_attribute
+
+template <>
+struct is_spawn_attribute<group_attribute> : public mpl::true_ {};
+
+} // namespace boost::mmm::detail
+
+/**
+ * <b>Returns</b>: An attribute which makes spawned <i>user-thread</i> belong
+ * to group g, to be passed as first argument of scheduler::add_thread.
+ * Contexts belong to group 0 by default. Contexts spawned by a
+ * <i>user-thread</i> do not inherit its group.
+ */
+inline detail::group_attribute
+in_group(std::size_t g) BOOST_MMM_NOEXCEPT
+{
+    const detail::group_attribute attr = { g };
+    return attr;
+}
+
+namespace this_ctx {
+
+/**
+ * <b>Returns</b>: Group of current context, or 0 if current context is not
+ * controlled under scheduler.
+ */
+inline std::size_t
+get_group()
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        return fusion::at_c<4>(*ctx_tuple).group;
+    }
+    return 0;
+}
+
+} // namespace boost::mmm::this_ctx
+
+} } // namespace boost::mmm
+
+#endif
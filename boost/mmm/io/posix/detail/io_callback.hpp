@@ -9,9 +9,16 @@
 #include <boost/mmm/detail/context.hpp>
 #include <boost/mmm/detail/current_context.hpp>
 
+#include <cerrno>
 #include <boost/optional.hpp>
 #include <boost/fusion/include/at.hpp>
 
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/chrono/ceil.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <boost/mmm/detail/array_ref.hpp>
+#include <boost/mmm/io/detail/poll.hpp>
 #include <boost/mmm/io/detail/check_events.hpp>
 
 namespace boost { namespace mmm { namespace io { namespace posix { namespace detail {
@@ -24,9 +31,14 @@ class posix_callback : public mmm::detail::io_callback_base
 protected:
     typedef T result_type;
 
+    typedef base_type::time_point time_point;
+
     explicit
-    posix_callback(base_type::event_type::type event, int fd)
-      : base_type(event), _m_fd(fd) {}
+    posix_callback(base_type::event_type::type event, int fd, const time_point &deadline)
+      : base_type(event), _m_fd(fd)
+    {
+        set_deadline(deadline);
+    }
 
     void
     set_result(result_type val) { _m_result = val; }
@@ -46,7 +58,7 @@ public:
     }
 
     virtual bool
-    done() const { return get_result() != boost::none; }
+    done() const { return timed_out() || get_result() != boost::none; }
 
     virtual bool
     is_aggregatable() const { return true; }
@@ -80,12 +92,49 @@ yield_blocker_syscall(posix_callback<T> &callback)
         fusion::at_c<1>(*ctx_tuple) = &callback;
         fusion::at_c<0>(*ctx_tuple).jump();
     }
+    else if (callback.has_deadline())
+    {
+        // Not controlled under scheduler, so wait for events until deadline
+        // here.
+        using mmm::detail::make_array_ref;
+        pollfd pfd = callback.get_pollfd();
+        system::error_code err_code;
+        const chrono::steady_clock::duration rest =
+          callback.get_deadline() - chrono::steady_clock::now();
+        if (rest <= chrono::steady_clock::duration::zero()
+         || io::detail::poll_fds(make_array_ref(&pfd, 1)
+              , chrono::ceil<chrono::milliseconds>(rest), err_code) == 0)
+        {
+            callback.time_out();
+        }
+        else
+        {
+            callback();
+        }
+    }
     else
     {
         callback();
     }
 }
 
+/**
+ * <b>Returns</b>: Result of the system call, or -1 with errno ETIMEDOUT if
+ * deadline of callback has passed before called.
+ */
+template <typename T>
+inline T
+get_syscall_result(const posix_callback<T> &callback)
+{
+    if (callback.timed_out())
+    {
+        errno = ETIMEDOUT;
+        return -1;
+    }
+    const boost::optional<T> result = callback.get_result();
+    return result != boost::none ? result.get() : -1;
+}
+
 } } } } } // namespace boost::mmm::io::posix::detail
 
 #endif // BOOST_MMM_IO_POSIX_DETAIL_IO_CALLBACK_HPP
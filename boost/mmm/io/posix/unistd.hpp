@@ -9,6 +9,7 @@
 #include <cstddef>
 
 #include <boost/optional.hpp>
+#include <boost/chrono/system_clocks.hpp>
 
 #include <boost/system/error_code.hpp>
 #include <boost/mmm/io/posix/detail/io_callback.hpp>
@@ -28,8 +29,8 @@ class read_callback : public posix_callback<ssize_t>
 
 public:
     explicit
-    read_callback(int fd, void *buf, std::size_t count)
-      : base_type(base_type::event_type::in, fd)
+    read_callback(int fd, void *buf, std::size_t count, const time_point &deadline)
+      : base_type(base_type::event_type::in, fd, deadline)
       , _m_buf(buf), _m_count(count) {}
 
     virtual void
@@ -42,17 +43,18 @@ public:
 } // namespace boost::mmm::io::posix::detail
 
 /**
- * <b>Effects</b>: Yield context execution to others and polling if the system
- * call will block. The behavior is same as origial one if current context is
- * not controlled under scheduler.
+ * <b>Effects</b>: Same as read(fd, buf, count), but gives up if fd is not
+ * readable until deadline. The context is suspended in a timer wheel of the
+ * poller meanwhile, so the deadline costs O(1) to arm and to cancel.
  *
- * <b>Returns</b>: Same as origial one.
+ * <b>Returns</b>: Same as origial one, or -1 with errno ETIMEDOUT.
  */
 inline ssize_t
-read(int fd, void *buf, std::size_t count)
+read(int fd, void *buf, std::size_t count
+, const chrono::steady_clock::time_point &deadline)
 {
     using namespace detail;
-    read_callback callback(fd, buf, count);
+    read_callback callback(fd, buf, count, deadline);
 
     system::error_code err_code;
     if (count == 0 || callback.check_events(err_code))
@@ -63,9 +65,20 @@ read(int fd, void *buf, std::size_t count)
     {
         yield_blocker_syscall(callback);
     }
+    return get_syscall_result(callback);
+}
 
-    const boost::optional<ssize_t> result = callback.get_result();
-    return result != boost::none ? result.get() : -1;
+/**
+ * <b>Effects</b>: Yield context execution to others and polling if the system
+ * call will block. The behavior is same as origial one if current context is
+ * not controlled under scheduler.
+ *
+ * <b>Returns</b>: Same as origial one.
+ */
+inline ssize_t
+read(int fd, void *buf, std::size_t count)
+{
+    return read(fd, buf, count, (chrono::steady_clock::time_point::max)());
 }
 
 namespace detail {
@@ -79,8 +92,8 @@ class write_callback : public posix_callback<ssize_t>
 
 public:
     explicit
-    write_callback(int fd, const void *buf, std::size_t count)
-      : base_type(base_type::event_type::out, fd)
+    write_callback(int fd, const void *buf, std::size_t count, const time_point &deadline)
+      : base_type(base_type::event_type::out, fd, deadline)
       , _m_buf(buf), _m_count(count) {}
 
     virtual void
@@ -93,17 +106,17 @@ public:
 } // namespace boost::mmm::io::posix::detail
 
 /**
- * <b>Effects</b>: Yield context execution to others and polling if the system
- * call will block. The behavior is same as origial one if current context is
- * not controlled under scheduler.
+ * <b>Effects</b>: Same as write(fd, buf, count), but gives up if fd is not
+ * writable until deadline, see read.
  *
- * <b>Returns</b>: Same as origial one.
+ * <b>Returns</b>: Same as origial one, or -1 with errno ETIMEDOUT.
  */
 inline ssize_t
-write(int fd, const void *buf, std::size_t count)
+write(int fd, const void *buf, std::size_t count
+, const chrono::steady_clock::time_point &deadline)
 {
     using namespace detail;
-    write_callback callback(fd, buf, count);
+    write_callback callback(fd, buf, count, deadline);
 
     system::error_code err_code;
     if (callback.check_events(err_code))
@@ -114,8 +127,20 @@ write(int fd, const void *buf, std::size_t count)
     {
         yield_blocker_syscall(callback);
     }
-    const boost::optional<ssize_t> result = callback.get_result();
-    return result != boost::none ? result.get() : -1;
+    return get_syscall_result(callback);
+}
+
+/**
+ * <b>Effects</b>: Yield context execution to others and polling if the system
+ * call will block. The behavior is same as origial one if current context is
+ * not controlled under scheduler.
+ *
+ * <b>Returns</b>: Same as origial one.
+ */
+inline ssize_t
+write(int fd, const void *buf, std::size_t count)
+{
+    return write(fd, buf, count, (chrono::steady_clock::time_point::max)());
 }
 
 } } } } // namespace boost::mmm:io::posix
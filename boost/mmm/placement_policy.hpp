@@ -0,0 +1,40 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_PLACEMENT_POLICY_HPP
+#define BOOST_MMM_PLACEMENT_POLICY_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+namespace boost { namespace mmm {
+
+/**
+ * Placement of <i>kernel-threads</i> on CPUs. Each <i>kernel-thread</i> is
+ * pinned to one CPU; CPUs are assigned node by node, and distinct physical
+ * cores before their SMT siblings. Idle <i>kernel-threads</i> steal from SMT
+ * siblings first, then from ones on the same NUMA node, then from others.
+ */
+struct placement_policy
+{
+    typedef std::size_t size_type;
+
+    // CPUs to use, all online CPUs if empty. Kernel-threads more than CPUs
+    // share them in round robin.
+    std::vector<size_type> cpus;
+
+    placement_policy() {}
+
+    explicit
+    placement_policy(const std::vector<size_type> &cpus)
+      : cpus(cpus) {}
+}; // struct placement_policy
+
+} } // namespace boost::mmm
+
+#endif
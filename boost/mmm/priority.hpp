@@ -0,0 +1,88 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_PRIORITY_HPP
+#define BOOST_MMM_PRIORITY_HPP
+
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mpl/bool.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/current_context.hpp>
+#include <boost/mmm/detail/spawn_attribute.hpp>
+
+#include <boost/fusion/include/at.hpp>
+
+namespace boost { namespace mmm {
+
+namespace detail {
+
+struct priority_attribute
+{
+    void
+    apply(context_tuple &ctx) const BOOST_MMM_NOEXCEPT
+    {
+        fusion::at_c<4>(ctx).priority = priority;
+    }
+
+    int priority;
+}; // struct priority_attribute
+
+template <>
+struct is_spawn_attribute<priority_attribute> : public mpl::true_ {};
+
+} // namespace boost::mmm::detail
+
+/**
+ * <b>Returns</b>: An attribute which sets priority of spawned
+ * <i>user-thread</i> to p, to be passed as first argument of
+ * scheduler::add_thread. Contexts are spawned with priority 0 by default.
+ */
+inline detail::priority_attribute
+with_priority(int p) BOOST_MMM_NOEXCEPT
+{
+    const detail::priority_attribute attr = { p };
+    return attr;
+}
+
+namespace this_ctx {
+
+/**
+ * <b>Effects</b>: Change priority of current context to p. It takes effect
+ * when the context is suspended next time. No effects if current context is
+ * not controlled under scheduler.
+ */
+inline void
+set_priority(int p)
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        fusion::at_c<4>(*ctx_tuple).priority = p;
+    }
+}
+
+/**
+ * <b>Returns</b>: Priority of current context, or 0 if current context is not
+ * controlled under scheduler.
+ */
+inline int
+get_priority()
+{
+    using namespace detail::current_context;
+    if (detail::context_tuple *ctx_tuple = get_current_ctx())
+    {
+        return fusion::at_c<4>(*ctx_tuple).priority;
+    }
+    return 0;
+}
+
+} // namespace boost::mmm::this_ctx
+
+} } // namespace boost::mmm
+
+#endif
@@ -0,0 +1,47 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_SCALING_POLICY_HPP
+#define BOOST_MMM_SCALING_POLICY_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/chrono/duration.hpp>
+#include <boost/mmm/detail/cpu_quota.hpp>
+
+namespace boost { namespace mmm {
+
+/**
+ * Parameters of automatic <i>kernel-threads</i> scaling. The scheduler samples
+ * its run-queue depth every interval, adds a <i>kernel-thread</i> when more
+ * than grow_threshold <i>user-threads</i> per <i>kernel-thread</i> are waiting,
+ * and removes one after shrink_samples consecutive samples found nothing to
+ * run while some <i>kernel-threads</i> were idle.
+ */
+struct scaling_policy
+{
+    typedef std::size_t size_type;
+
+    size_type min_kernels;
+    // Defaults to hardware concurrency limited by cgroup CPU quota.
+    size_type max_kernels;
+    size_type grow_threshold;
+    size_type shrink_samples;
+    chrono::milliseconds interval;
+
+    scaling_policy()
+      : min_kernels(1), max_kernels(detail::available_concurrency())
+      , grow_threshold(4), shrink_samples(10), interval(100) {}
+
+    scaling_policy(size_type min, size_type max)
+      : min_kernels(min), max_kernels(max)
+      , grow_threshold(4), shrink_samples(10), interval(100) {}
+}; // struct scaling_policy
+
+} } // namespace boost::mmm
+
+#endif
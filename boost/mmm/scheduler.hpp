@@ -7,8 +7,10 @@
 #define BOOST_MMM_SCHEDULER_HPP
 
 #include <cstddef>
+#include <new>
 #include <utility>
 #include <memory>
+#include <vector>
 
 #include <boost/config.hpp>
 #include <boost/mmm/detail/workaround.hpp>
@@ -30,13 +32,20 @@
 #endif
 
 #include <boost/utility/enable_if.hpp>
+#include <boost/utility/addressof.hpp>
+#include <boost/utility/typed_in_place_factory.hpp>
 #include <boost/type_traits/is_same.hpp>
+#include <boost/iterator/iterator_traits.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/or.hpp>
 
 #include <boost/mmm/detail/context.hpp>
 #include <boost/mmm/detail/thread/thread.hpp>
 #include <boost/mmm/detail/thread/future.hpp>
+#include <boost/mmm/future_group.hpp>
 #include <boost/utility/result_of.hpp>
 #include <boost/fusion/include/at.hpp>
+#include <boost/phoenix/bind/bind_function.hpp>
 #include <boost/phoenix/bind/bind_function_object.hpp>
 
 #include <boost/system/error_code.hpp>
@@ -44,12 +53,15 @@
 #include <boost/atomic.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/mmm/detail/thread/locks.hpp>
+#include <boost/mmm/detail/thread/sleep.hpp>
 
-#include <boost/checked_delete.hpp>
+#include <boost/exception_ptr.hpp>
 #include <boost/interprocess/smart_ptr/unique_ptr.hpp>
 
 #include <boost/chrono/duration.hpp>
+#include <boost/chrono/system_clocks.hpp>
 #include <boost/mmm/detail/async_io_thread.hpp>
 
 #include <functional>
@@ -61,15 +73,68 @@
 #include <boost/container/map.hpp>
 #endif
 
+#include <boost/mmm/detail/allocator_deleter.hpp>
 #include <boost/mmm/detail/current_context.hpp>
 #include <boost/mmm/detail/context_guard.hpp>
+#include <boost/mmm/detail/kernel_data.hpp>
+#include <boost/mmm/detail/context_node.hpp>
+#include <boost/mmm/detail/context_queue.hpp>
+#include <boost/mmm/detail/injection_queue.hpp>
+#include <boost/mmm/detail/eventcount.hpp>
+#include <boost/mmm/detail/timer_wheel.hpp>
+#include <boost/mmm/detail/spawn_attribute.hpp>
+#include <boost/mmm/detail/push_context.hpp>
+#include <boost/mmm/detail/stack_pool.hpp>
+#include <boost/mmm/detail/stack_profiler.hpp>
+#include <boost/mmm/deadline.hpp>
 #include <boost/mmm/strategy_traits.hpp>
 #include <boost/mmm/scheduler_traits.hpp>
+#include <boost/mmm/scaling_policy.hpp>
+#include <boost/mmm/stack_profile.hpp>
+#include <boost/mmm/affinity.hpp>
+#include <boost/mmm/placement_policy.hpp>
+#include <boost/mmm/detail/topology.hpp>
 
 #if !defined(BOOST_MMM_SCHEDULER_MAX_ARITY)
 #   define BOOST_MMM_SCHEDULER_MAX_ARITY 10
 #endif
 
+// Capacity of lock-free queue for contexts spawned from outside of
+// kernel-threads, should be power of 2. add_thread falls back to locking
+// scheduler when the queue is full.
+#if !defined(BOOST_MMM_SCHEDULER_INJECTION_QUEUE_SIZE)
+#   define BOOST_MMM_SCHEDULER_INJECTION_QUEUE_SIZE 1024
+#endif
+
+// Maximum number of contexts a kernel-thread takes from the injection queue
+// at once.
+#if !defined(BOOST_MMM_SCHEDULER_INJECTION_BATCH_SIZE)
+#   define BOOST_MMM_SCHEDULER_INJECTION_BATCH_SIZE 32
+#endif
+
+// Maximum number of consecutive contexts a kernel-thread resumes from its
+// run-next slot before others in the queue.
+#if !defined(BOOST_MMM_SCHEDULER_RUN_NEXT_LIMIT)
+#   define BOOST_MMM_SCHEDULER_RUN_NEXT_LIMIT 16
+#endif
+
+// Number of checks an idle kernel-thread spins for new contexts without
+// locking before parking.
+#if !defined(BOOST_MMM_SCHEDULER_SPIN_COUNT)
+#   define BOOST_MMM_SCHEDULER_SPIN_COUNT 1000
+#endif
+
+// Resolution of sleeping contexts' deadlines, in microseconds.
+#if !defined(BOOST_MMM_SCHEDULER_TIMER_RESOLUTION)
+#   define BOOST_MMM_SCHEDULER_TIMER_RESOLUTION 1000
+#endif
+
+// Number of slots of the timer wheel, should be power of 2. Deadlines within
+// a revolution are found without scanning later ones.
+#if !defined(BOOST_MMM_SCHEDULER_TIMER_SLOTS)
+#   define BOOST_MMM_SCHEDULER_TIMER_SLOTS 512
+#endif
+
 namespace boost { namespace mmm {
 
 namespace detail {
@@ -110,30 +175,98 @@ struct scheduler_data : private noncopyable
     typedef typename map_type<thread::id, thread>::type kernels_type;
     typedef typename StrategyTraits::pool_type users_type;
 
+    typedef
+      detail::kernel_data<typename StrategyTraits::context_type, Allocator>
+    kernel_type;
+    typedef detail::kernel_list<kernel_type, Allocator> locals_type;
+    typedef std::vector<detail::cpu_info> cpus_type;
+
+    typedef
+      detail::context_node<typename StrategyTraits::context_type>
+    node_type;
+    typedef
+      detail::injection_queue<typename node_type::pointer, Allocator>
+    injected_type;
+    typedef
+      detail::timer_wheel<typename StrategyTraits::context_type, Allocator>
+    timers_type;
+
     typedef
       detail::async_io_thread<SchedulerTraits, StrategyTraits, Allocator>
     async_io_thread;
-    // XXX: Should use specified allocator.
     typedef
-      interprocess::unique_ptr<async_io_thread, checked_deleter<async_io_thread> >
+      interprocess::unique_ptr<async_io_thread, allocator_deleter<async_io_thread, Allocator> >
     async_pool_type;
 
+    typedef
+      detail::stack_pool<typename stack_allocator_of<Allocator>::type>
+    stack_pool_type;
+
+    // Stacks of completed contexts. Declared first to be destroyed last,
+    // since contexts in others return their stacks to it.
+    stack_pool_type     stacks;
+    // Stack usage of each entry function, while profiling.
+    stack_profiler      profiler;
+
+    // Number of not completed contexts, includes running, sleeping and I/O
+    // waiting ones.
+    atomic<std::size_t> lives;
+    // Number of contexts in locals, run-next slots and injected.
+    atomic<std::size_t> queued;
+
     atomic<int>        status;
-    unsigned           runnings;
     mutex              mtx;
-    condition_variable cond;
+    // Serializes adding and removing kernels, should be locked before mtx.
+    mutex              resize_mtx;
+    // Idle kernels park on idle, callers of join_all wait on join_cond.
+    eventcount         idle;
+    condition_variable join_cond;
     kernels_type       kernels;
     users_type         users;
+    locals_type        locals;
+    injected_type      injected;
+    // Sleeping contexts, expired by any of kernels and async_pool.
+    timers_type        timers;
     async_pool_type    async_pool;
+    // Auto-scaling monitor, not-a-thread unless enabled.
+    thread             monitor;
+    // Policy of the monitor, to restart it on moving the scheduler.
+    scaling_policy     scaling;
+    // CPUs to bind kernels, guarded by resize_mtx. Empty unless placed.
+    cpus_type          cpus;
 
+    thread_specific_ptr<kernel_type> current_kernel;
+
+    // The poller refers to *this, which stays at same address while the
+    // scheduler is moved.
     template <typename Rep, typename Period>
-    scheduler_data(SchedulerTraits scheduler_traits, chrono::duration<Rep, Period> poll_TO)
-      : status(0), runnings(0)
-      , async_pool(new async_io_thread(scheduler_traits, StrategyTraits(), poll_TO)) {}
+    explicit
+    scheduler_data(chrono::duration<Rep, Period> poll_TO)
+      : lives(0), queued(0), status(0)
+      , injected(BOOST_MMM_SCHEDULER_INJECTION_QUEUE_SIZE)
+      , timers(chrono::microseconds(BOOST_MMM_SCHEDULER_TIMER_RESOLUTION)
+             , BOOST_MMM_SCHEDULER_TIMER_SLOTS)
+      , current_kernel(&no_cleanup)
+    {
+        allocation_guard<async_io_thread, Allocator> guard;
+        ::new (guard.get()) async_io_thread(SchedulerTraits(*this), StrategyTraits(), poll_TO
+        , chrono::microseconds(BOOST_MMM_SCHEDULER_TIMER_RESOLUTION)
+        , BOOST_MMM_SCHEDULER_TIMER_SLOTS);
+        async_pool.reset(guard.release());
+    }
 
     explicit
     scheduler_data(disabling_asio_pool)
-      : status(0), runnings(0) {}
+      : lives(0), queued(0), status(0)
+      , injected(BOOST_MMM_SCHEDULER_INJECTION_QUEUE_SIZE)
+      , timers(chrono::microseconds(BOOST_MMM_SCHEDULER_TIMER_RESOLUTION)
+             , BOOST_MMM_SCHEDULER_TIMER_SLOTS)
+      , current_kernel(&no_cleanup) {}
+
+private:
+    // Kernel data is owned by locals, not by thread specific storage.
+    static void
+    no_cleanup(kernel_type *) {}
 }; // template struct scheduler_data
 
 } // namespace boost::mmm::detail
@@ -172,131 +305,988 @@ private:
     typedef detail::scheduler_data<scheduler_traits, strategy_traits, allocator_type> scheduler_data;
     typedef typename scheduler_data::kernels_type kernels_type;
     typedef typename scheduler_data::users_type users_type;
+    typedef typename scheduler_data::kernel_type kernel_type;
+    typedef typename scheduler_data::timers_type timers_type;
 
 public:
     typedef typename strategy_traits::context_type context_type;
 
 private:
+    // Spawned contexts to be pushed at once, linked through their hooks.
+    typedef detail::context_queue<context_type> contexts_type;
+
 #if !defined(BOOST_MMM_DOXYGEN_INVOKED)
-    void
-    _m_jump_context(unique_lock<mutex> &guard, scheduler_data &data, context_type &ctx)
+    static bool
+    is_completed(const context_type &ctx) BOOST_MMM_NOEXCEPT
+    {
+        using fusion::at_c;
+        return at_c<0>(ctx) && at_c<0>(ctx).is_complete();
+    }
+
+    static bool
+    is_suspended(const context_type &ctx) BOOST_MMM_NOEXCEPT
+    {
+        using fusion::at_c;
+        return at_c<0>(ctx) && !at_c<0>(ctx).is_complete();
+    }
+
+    static bool
+    is_pinned(const context_type &ctx) BOOST_MMM_NOEXCEPT
+    {
+        return fusion::at_c<2>(ctx).pinned;
+    }
+
+    // Lazily computed, since result_of might not be instantiable with
+    // arguments for other overloads.
+    template <typename Signature>
+    struct future_of
+    {
+        typedef BOOST_MMM_THREAD_FUTURE<typename result_of<Signature>::type> type;
+    }; // template struct future_of
+
+    template <typename Fn>
+    struct is_add_thread_option
+      : public mpl::or_<
+          is_same<size_type, Fn>
+        , is_same<detail::kernel_placement, Fn>
+        , detail::is_spawn_attribute<Fn> > {};
+
+    static void
+    _m_jump_context(unique_lock<mutex> &guard, scheduler_data &data
+    , kernel_type &kernel, context_type &ctx)
+    {
+        detail::unique_unlock<mutex> unguard(guard);
+        _m_run_context(data, kernel, ctx);
+    }
+
+    static void
+    _m_run_context(scheduler_data &data, kernel_type &kernel, context_type &ctx)
     {
         using namespace detail;
-        unique_unlock<mutex> unguard(guard);
 
+        context_attributes &attrs = fusion::at_c<4>(ctx);
         io_callback_base *&callback = fusion::at_c<1>(ctx);
         if (callback)
         {
-            BOOST_ASSERT(!callback->done());
-            if (!data.async_pool || !callback->is_aggregatable())
+            // Timed out by the poller, see async_io_thread::expire_deadlines.
+            BOOST_ASSERT(!callback->done() || callback->timed_out());
+            if (!callback->timed_out() && (!data.async_pool || !callback->is_aggregatable()))
             {
                 system::error_code err_code;
-                if (callback->check_events(err_code))
+                if (!callback->check_events(err_code))
                 {
                     // No events were occured.
-                    return;
+                    if (!callback->has_deadline()
+                     || timers_type::clock_type::now() < callback->get_deadline())
+                    {
+                        // Pushed back without running, not to be taken as
+                        // suspended for I/O again.
+                        attrs.reason = suspension_yielded;
+                        attrs.ran = attrs.ran.zero();
+                        return;
+                    }
+                    callback->time_out();
                 }
             }
-            callback->operator()();
+            if (!callback->timed_out()) { callback->operator()(); }
             if (callback->done()) { callback = initialized_value; }
         }
 
+        context_affinity &affinity = fusion::at_c<2>(ctx);
+        BOOST_ASSERT(!affinity.pinned || affinity.kernel == kernel.index());
+        affinity.kernel = kernel.index();
+
+        typedef typename timers_type::clock_type clock_type;
+        const bool measures =
+          measures_run_time<strategy_traits>::value || accepts_push_info<strategy_traits>::value;
+
+        kernel.set_busy(true);
+        const typename clock_type::time_point start =
+          measures ? clock_type::now() : typename clock_type::time_point();
         current_context::set_current_ctx(&ctx);
         fusion::at_c<0>(ctx).jump();
         current_context::set_current_ctx(0);
+        if (measures) { attrs.ran = clock_type::now() - start; }
+        kernel.set_busy(false);
+
+        // Spawned while profiling, see _m_make_context.
+        if (attrs.entry && fusion::at_c<0>(ctx).is_complete())
+        {
+            data.profiler.record_usage(attrs.entry, fusion::at_c<0>(ctx).stack_used());
+        }
 
-        if (data.async_pool && callback && callback->is_aggregatable())
+        // Requested to sleep, see this_ctx::sleep_until.
+        context_timer &timer = fusion::at_c<3>(ctx);
+        if (timer.armed)
         {
-            data.async_pool->push_ctx(boost::move(ctx));
+            const context_timer::time_point deadline = timer.deadline;
+            timer.armed = false;
+            attrs.reason = suspension_timer;
+            data.timers.insert(boost::move(ctx), deadline);
+            return;
         }
+        if (callback)
+        {
+            attrs.reason = suspension_io;
+            // Others waiting for I/O are polled by kernels each time resumed,
+            // so not ready yet when pushed.
+            if (data.async_pool && callback->is_aggregatable())
+            {
+                data.async_pool->push_ctx(boost::move(ctx));
+            }
+            return;
+        }
+        attrs.reason = suspension_yielded;
     }
 
-    void
-    _m_exec(scheduler_data &data)
+    static void
+    _m_exec(scheduler_data &data, kernel_type &kernel)
+    {
+#if BOOST_MMM_STACK_RESERVE
+        // To report overflow of reserved stacks, see register_stack_guard.
+        const detail::alternate_signal_stack altstack;
+#endif
+        data.current_kernel.reset(&kernel);
+        // Lock-free strategies are driven in same way as work stealing, not
+        // to lock around each of resuming.
+        _m_exec(data, kernel, typename mpl::or_<
+          is_work_stealing<strategy_traits>, is_lock_free<strategy_traits> >::type());
+        _m_drain_local(data, kernel);
+        data.current_kernel.release();
+    }
+
+    static void
+    _m_exec(scheduler_data &data, kernel_type &kernel, mpl::false_)
+    {
+        while (!(data.status & _st_terminate) && !kernel.is_retiring())
+        {
+            _m_expire_timers(data);
+
+            context_type ctx;
+            if (_m_acquire_prior(data, kernel, ctx))
+            {
+                _m_run_acquired(data, kernel, ctx);
+                continue;
+            }
+
+            unique_lock<mutex> guard(data.mtx);
+            _m_import_injected(data);
+            if (!data.users.size())
+            {
+                guard.unlock();
+                if (_m_steal_run_next(data, kernel, ctx))
+                {
+                    _m_run_acquired(data, kernel, ctx);
+                }
+                else
+                {
+                    _m_idle(data, kernel);
+                }
+                continue;
+            }
+
+            bool completed, suspended;
+            {
+                context_guard ctx_guard((scheduler_traits(data)), strategy_traits());
+                _m_jump_context(guard, data, kernel, ctx_guard.context());
+                completed = is_completed(ctx_guard.context());
+                suspended = static_cast<bool>(ctx_guard);
+                if (completed)
+                {
+                    _m_account_completed(data, ctx_guard.context(), measures_run_time<strategy_traits>());
+                }
+
+                // Pinned one should not be queued to shared pool.
+                if (suspended && is_pinned(ctx_guard.context()))
+                {
+                    kernel.post(boost::move(ctx_guard.context()));
+                    suspended = false;
+                }
+            }
+            // This kernel will resume one of them by itself.
+            const bool wakeup = suspended && 1 < data.users.size();
+            guard.unlock();
+
+            if (completed) { _m_complete(data); }
+            if (wakeup) { data.idle.notify_one(); }
+        }
+    }
+
+    static void
+    _m_exec(scheduler_data &data, kernel_type &kernel, mpl::true_)
+    {
+        while (!(data.status & _st_terminate) && !kernel.is_retiring())
+        {
+            _m_expire_timers(data);
+
+            context_type ctx;
+            if (_m_acquire_context(data, kernel, ctx))
+            {
+                _m_run_acquired(data, kernel, ctx);
+            }
+        }
+    }
+
+    // Run a context taken without context_guard, and push it back if
+    // suspended.
+    static void
+    _m_run_acquired(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        _m_run_context(data, kernel, ctx);
+
+        if (is_suspended(ctx))
+        {
+            _m_push_ready(data, kernel, boost::move(ctx), false);
+        }
+        else if (is_completed(ctx))
+        {
+            if (measures_run_time<strategy_traits>::value)
+            {
+                unique_lock<mutex> guard(data.mtx);
+                _m_account_completed(data, ctx, measures_run_time<strategy_traits>());
+            }
+            _m_complete(data);
+        }
+    }
+
+    // Let the strategy account the last run of completed context. Must be
+    // called with lock.
+    static void
+    _m_account_completed(scheduler_data &data, context_type &ctx, mpl::true_)
+    {
+        strategy_traits().complete_ctx(scheduler_traits(data), ctx);
+    }
+
+    static void
+    _m_account_completed(scheduler_data &, context_type &, mpl::false_) {}
+
+    // Hand over local contexts of retiring kernel to the shared pool.
+    static void
+    _m_drain_local(scheduler_data &data, kernel_type &kernel)
+    {
+        size_type n = 0;
+        {
+            unique_lock<mutex> guard(data.mtx);
+            context_type ctx;
+            while (kernel.pop_local(ctx) || kernel.take_run_next(ctx))
+            {
+                detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+                // queued should be decremented after pushing, see _m_idle.
+                --data.queued;
+                ++n;
+            }
+            // No more contexts are posted after retiring, see _m_push_affine.
+            while (kernel.take_mailed(ctx))
+            {
+                fusion::at_c<2>(ctx).pinned = false;
+                detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+                ++n;
+            }
+        }
+        if (n) { data.idle.notify(n); }
+        // Others might park without knowing deadlines inserted by this kernel.
+        if (data.timers.size()) { data.idle.notify_one(); }
+    }
+
+    // Queue contexts whose deadline has been reached. Returns immediately if
+    // others are expiring.
+    static void
+    _m_expire_timers(scheduler_data &data)
     {
-        while (!(data.status & _st_terminate))
+        if (!data.timers.size()) { return; }
+
+        typename timers_type::expired_list expired;
+        const size_type n = data.timers.expire(timers_type::clock_type::now(), expired);
+        if (!n) { return; }
+
         {
-            // Lock until to be able to get least one context.
             unique_lock<mutex> guard(data.mtx);
-            // Check and breaking loop when destructing scheduler.
-            while (!(data.status & _st_terminate) && !data.users.size())
+            context_type ctx;
+            while (expired.pop(ctx))
+            {
+                if (!_m_push_affine(data, ctx))
+                {
+                    detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+                }
+            }
+        }
+        data.idle.notify(n);
+    }
+
+    // Shorter one of timeout and time until the earliest deadline, rounded up
+    // to milliseconds since pollers cannot wait shorter.
+    template <typename Rep, typename Period>
+    static chrono::nanoseconds
+    _m_timer_timeout(scheduler_data &data, chrono::duration<Rep, Period> timeout)
+    {
+        typedef chrono::nanoseconds nanoseconds;
+        typedef chrono::milliseconds milliseconds;
+
+        const nanoseconds limit = chrono::duration_cast<nanoseconds>(timeout);
+        typename timers_type::time_point deadline;
+        if (!data.timers.next_expiry(deadline)) { return limit; }
+
+        const nanoseconds rest = deadline - timers_type::clock_type::now();
+        if (rest <= nanoseconds::zero()) { return nanoseconds::zero(); }
+
+        const nanoseconds until =
+          chrono::duration_cast<milliseconds>(rest + milliseconds(1) - nanoseconds(1));
+        return until < limit ? until : limit;
+    }
+
+    static void
+    _m_complete(scheduler_data &data)
+    {
+        // lives should be decremented before checking status, see join_all.
+        if (--data.lives == 0 && (data.status & _st_join))
+        {
+            lock_guard<mutex> guard(data.mtx);
+            data.join_cond.notify_all();
+        }
+    }
+
+    // Spin for a while without locking, then park until notified.
+    static void
+    _m_idle(scheduler_data &data, kernel_type &kernel)
+    {
+        const detail::eventcount::key_type key = data.idle.prepare_wait();
+        for (int i = 0; i < BOOST_MMM_SCHEDULER_SPIN_COUNT; ++i)
+        {
+            if (data.idle.changed(key) || data.queued || kernel.mailed()
+              || (data.status & _st_terminate) || kernel.is_retiring())
+            {
+                return;
+            }
+            detail::cpu_relax();
+        }
+
+        {
+            // Contexts pushed before prepare_wait are visible here, others
+            // change the key.
+            unique_lock<mutex> guard(data.mtx);
+            if (data.users.size() || data.queued || kernel.mailed()
+              || (data.status & _st_terminate) || kernel.is_retiring())
+            {
+                return;
+            }
+        }
+
+        // Sleeping contexts are inserted by running kernels, which take care
+        // of them until parking.
+        typename timers_type::time_point deadline;
+        if (data.timers.next_expiry(deadline))
+        {
+            if (deadline <= timers_type::clock_type::now()) { return; }
+            data.idle.commit_wait(kernel.get_parker(), key, deadline);
+            return;
+        }
+        // TODO: Check interrupts.
+        data.idle.commit_wait(kernel.get_parker(), key);
+    }
+
+    // Try run-next slot, mailbox, local deque, shared pool and other kernels
+    // in that order. Returns false after waiting for new contexts.
+    static bool
+    _m_acquire_context(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        if (_m_acquire_prior(data, kernel, ctx)) { return true; }
+
+        if (kernel.pop_local(ctx) || _m_import_injected(data, kernel, ctx))
+        {
+            --data.queued;
+            return true;
+        }
+
+        if (_m_pop_shared(data, ctx)) { return true; }
+
+        if (_m_steal_context(data, kernel, ctx) || _m_steal_run_next(data, kernel, ctx))
+        {
+            return true;
+        }
+
+        _m_idle(data, kernel);
+        return false;
+    }
+
+    // Take the context in own run-next slot or mailbox. After too many
+    // consecutive ones, others should be resumed first so that a ping-pong
+    // pair or a yielding pinned context cannot starve them.
+    static bool
+    _m_acquire_prior(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        if (BOOST_MMM_SCHEDULER_RUN_NEXT_LIMIT <= kernel.handoffs())
+        {
+            kernel.reset_handoffs();
+            if (!kernel.take_run_next(ctx)) { return false; }
+            --data.queued;
+
+            // Local deque is LIFO, so queue it to the shared pool.
+            _m_push_shared(data, boost::move(ctx));
+            data.idle.notify_one();
+            return false;
+        }
+
+        if (kernel.take_run_next(ctx))
+        {
+            --data.queued;
+        }
+        else if (!kernel.take_mailed(ctx))
+        {
+            kernel.reset_handoffs();
+            return false;
+        }
+        kernel.count_handoff();
+        return true;
+    }
+
+    // Take the context in run-next slot of other kernel which is busy
+    // running the producer.
+    static bool
+    _m_steal_run_next(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        return _m_take_from_others(data, kernel, ctx, &kernel_type::take_run_next);
+    }
+
+    static bool
+    _m_steal_context(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        return _m_take_from_others(data, kernel, ctx, &kernel_type::steal);
+    }
+
+    // Visit other kernels nearer first: SMT siblings, same NUMA node, then
+    // others.
+    static bool
+    _m_take_from_others(scheduler_data &data, kernel_type &kernel, context_type &ctx
+    , bool (kernel_type::*take)(context_type &))
+    {
+        const typename scheduler_data::locals_type::view locals = data.locals.get_view();
+        const size_type size = locals.size();
+        for (int distance = kernel.is_located() ? 0 : 2; distance <= 2; ++distance)
+        {
+            for (size_type i = 1; i < size; ++i)
             {
-                // TODO: Check interrupts.
-                data.cond.wait(guard);
+                kernel_type &victim = locals[(kernel.index() + i) % size];
+                if (kernel.distance(victim) == distance && (victim.*take)(ctx))
+                {
+                    --data.queued;
+                    return true;
+                }
             }
-            if (data.status & _st_terminate) { break; }
+        }
+        return false;
+    }
+
+    // Move a batch of injected contexts to strategy's pool. Must be called
+    // with lock.
+    static void
+    _m_import_injected(scheduler_data &data)
+    {
+        typedef typename scheduler_data::node_type node_type;
+
+        typename node_type::pointer p;
+        size_type n = 0;
+        for (; n < BOOST_MMM_SCHEDULER_INJECTION_BATCH_SIZE && data.injected.try_pop(p); ++n)
+        {
+            context_type ctx;
+            node_type::release(p, ctx);
+            --data.queued;
+            detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+        }
+        if (1 < n) { data.idle.notify_one(); }
+    }
+
+    // Take a batch of injected contexts; first one is stored to ctx, others
+    // are moved to local deque without changing queued.
+    static bool
+    _m_import_injected(scheduler_data &data, kernel_type &kernel, context_type &ctx)
+    {
+        typedef typename scheduler_data::node_type node_type;
+
+        typename node_type::pointer p;
+        if (!data.injected.try_pop(p)) { return false; }
+        node_type::release(p, ctx);
+
+        size_type n = 1;
+        for (; n < BOOST_MMM_SCHEDULER_INJECTION_BATCH_SIZE && data.injected.try_pop(p); ++n)
+        {
+            context_type other;
+            node_type::release(p, other);
+            kernel.push_local(boost::move(other));
+        }
+        if (1 < n) { data.idle.notify_one(); }
+        return true;
+    }
+
+    static void
+    _m_push_local(scheduler_data &data, kernel_type &kernel
+    , BOOST_RV_REF(context_type) ctx, bool spawned)
+    {
+        // queued should be incremented before pushing, or thieves might
+        // decrement it first.
+        ++data.queued;
+        kernel.push_local(boost::move(ctx));
+
+        // Yielded context will be resumed by this kernel immediately unless
+        // others are queued.
+        if (spawned || 1 < kernel.local_size()) { data.idle.notify_one(); }
+    }
+
+    // Push to mailbox, local deque or shared pool depending on affinity and
+    // strategy.
+    static void
+    _m_push_ready(scheduler_data &data, kernel_type &kernel
+    , BOOST_RV_REF(context_type) ctx, bool spawned)
+    {
+        if (is_pinned(ctx))
+        {
+            // Pinned to this kernel, see _m_run_context.
+            kernel.post(boost::move(ctx));
+            return;
+        }
+
+        // Ordered strategies should see all of contexts, as _m_queue_spawned.
+        if (is_work_stealing<strategy_traits>::value && !is_ordered<strategy_traits>::value)
+        {
+            _m_push_local(data, kernel, boost::move(ctx), spawned);
+            return;
+        }
+
+        // Yielded context will be resumed by this kernel immediately unless
+        // others are queued.
+        const bool queued = _m_push_shared(data, boost::move(ctx));
+        if (spawned || queued) { data.idle.notify_one(); }
+    }
+
+    // Pop a context from the strategy's pool. Returns false if empty.
+    static bool
+    _m_pop_shared(scheduler_data &data, context_type &ctx)
+    {
+        return _m_pop_shared(data, ctx, is_lock_free<strategy_traits>());
+    }
+
+    static bool
+    _m_pop_shared(scheduler_data &data, context_type &ctx, mpl::false_)
+    {
+        unique_lock<mutex> guard(data.mtx);
+        if (!data.users.size()) { return false; }
+        strategy_traits().pop_ctx(scheduler_traits(data)).swap(ctx);
+        return true;
+    }
+
+    static bool
+    _m_pop_shared(scheduler_data &data, context_type &ctx, mpl::true_)
+    {
+        return strategy_traits().try_pop_ctx(scheduler_traits(data), ctx);
+    }
+
+    // Push a context to the strategy's pool. Returns true iff others were
+    // queued in the pool.
+    static bool
+    _m_push_shared(scheduler_data &data, BOOST_RV_REF(context_type) ctx)
+    {
+        return _m_push_shared(data, boost::move(ctx), is_lock_free<strategy_traits>());
+    }
+
+    static bool
+    _m_push_shared(scheduler_data &data, BOOST_RV_REF(context_type) ctx, mpl::false_)
+    {
+        unique_lock<mutex> guard(data.mtx);
+        detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+        return 1 < data.users.size();
+    }
+
+    static bool
+    _m_push_shared(scheduler_data &data, BOOST_RV_REF(context_type) ctx, mpl::true_)
+    {
+        return !detail::push_context(strategy_traits(), scheduler_traits(data), boost::move(ctx));
+    }
+
+    // Context made runnable by the running one is resumed next on this
+    // kernel, while its data is still in cache. A displaced one is queued.
+    static void
+    _m_push_run_next(scheduler_data &data, kernel_type &kernel
+    , BOOST_RV_REF(context_type) ctx)
+    {
+        // queued should be incremented before storing, see _m_push_local.
+        ++data.queued;
+
+        context_type displaced;
+        if (kernel.put_run_next(boost::move(ctx), displaced))
+        {
+            --data.queued;
+            _m_push_ready(data, kernel, boost::move(displaced), true);
+        }
+    }
+
+    // Post ctx to mailbox of its last kernel if pinned, or if the kernel is
+    // not busy so that it resumes ctx with warm cache. Returns false if ctx
+    // should be queued as usual; a pinned one is unpinned if its kernel is
+    // not running. Must be called with lock.
+    static bool
+    _m_push_affine(scheduler_data &data, context_type &ctx)
+    {
+        using detail::context_affinity;
+
+        context_affinity &affinity = fusion::at_c<2>(ctx);
+        if (affinity.kernel == context_affinity::no_kernel) { return false; }
+        // Ordered strategies should see unpinned ones woken by I/O or timers,
+        // as _m_queue_spawned.
+        if (!affinity.pinned && is_ordered<strategy_traits>::value) { return false; }
+
+        // Kernels retire with lock, and drain their mailbox after that.
+        const typename scheduler_data::locals_type::view locals = data.locals.get_view();
+        if (!(affinity.kernel < locals.size()) || !locals[affinity.kernel].is_active())
+        {
+            affinity.pinned = false;
+            return false;
+        }
+
+        kernel_type &kernel = locals[affinity.kernel];
+        if (!affinity.pinned && kernel.is_busy()) { return false; }
+
+        kernel.post(boost::move(ctx));
+        data.idle.notify(kernel.get_parker());
+        return true;
+    }
+
+    void
+    _m_push_spawned(BOOST_RV_REF(context_type) rv, detail::kernel_placement where)
+    {
+        context_type &ctx = rv;
+        detail::context_affinity &affinity = fusion::at_c<2>(ctx);
+        affinity.kernel = where.kernel;
+        affinity.pinned = true;
+
+        ++_m_data->lives;
+        {
+            unique_lock<mutex> guard(_m_data->mtx);
+            if (_m_push_affine(*_m_data, ctx)) { return; }
+        }
+        _m_queue_spawned(boost::move(ctx));
+    }
+
+    void
+    _m_push_spawned(BOOST_RV_REF(context_type) ctx)
+    {
+        ++_m_data->lives;
+        _m_queue_spawned(boost::move(ctx));
+    }
+
+    void
+    _m_queue_spawned(BOOST_RV_REF(context_type) ctx)
+    {
+        // Ordered strategies should see all of contexts, not to resume
+        // spawned ones ahead of more preferred ones.
+        if (is_ordered<strategy_traits>::value)
+        {
+            _m_push_shared(*_m_data, boost::move(ctx));
+            _m_data->idle.notify_one();
+            return;
+        }
+
+        if (kernel_type *kernel = _m_data->current_kernel.get())
+        {
+            _m_push_run_next(*_m_data, *kernel, boost::move(ctx));
+            return;
+        }
 
-            context_guard ctx_guard(scheduler_traits(*this), strategy_traits());
+        // Spawning from outside of kernel-threads should not contend with
+        // kernel-threads on the scheduler lock, which lock-free strategies
+        // do not take.
+        if (is_lock_free<strategy_traits>::value)
+        {
+            _m_push_shared(*_m_data, boost::move(ctx));
+            _m_data->idle.notify_one();
+            return;
+        }
 
-            ++data.runnings;
-            _m_jump_context(guard, data, ctx_guard.context());
-            --data.runnings;
+        typedef typename scheduler_data::node_type node_type;
+        const typename node_type::pointer p = node_type::create(boost::move(ctx));
+        ++_m_data->queued;
+        if (_m_data->injected.try_push(p))
+        {
+            _m_data->idle.notify_one();
+            return;
+        }
+        --_m_data->queued;
+        node_type::release(p, ctx);
+
+        _m_push_shared(*_m_data, boost::move(ctx));
+        _m_data->idle.notify_one();
+    }
+
+    // Push all contexts with one locking and one round of notifications.
+    void
+    _m_push_spawned(contexts_type &ctxs)
+    {
+        const size_type n = ctxs.size();
+        if (!n) { return; }
+        _m_data->lives += n;
 
-            // Notify all even if context is finished to wakeup caller of join_all.
-            if (data.status & _st_join)
+        kernel_type *kernel = _m_data->current_kernel.get();
+        if (kernel && is_work_stealing<strategy_traits>::value && !is_ordered<strategy_traits>::value)
+        {
+            _m_data->queued += n;
+            context_type ctx;
+            while (ctxs.pop(ctx))
             {
-                // NOTICE: Because of using notify_all instead of notify_one,
-                // notify_one might wake up not caller of join_all.
-                data.cond.notify_all();
+                kernel->push_local(boost::move(ctx));
             }
-            // Notify one when context is not finished.
-            else if (ctx_guard)
+            // This kernel will run one of them by itself.
+            if (1 < n) { _m_data->idle.notify(n - 1); }
+            return;
+        }
+
+        {
+            unique_lock<mutex> guard(_m_data->mtx);
+            context_type ctx;
+            while (ctxs.pop(ctx))
             {
-                data.cond.notify_one();
+                detail::push_context(strategy_traits(), scheduler_traits(*_m_data), boost::move(ctx));
             }
         }
+        _m_data->idle.notify(n);
+    }
+
+    // Returns 0 unless profiling stacks.
+    template <typename Fn>
+    const void *
+    _m_entry_of(const Fn &fn) const BOOST_MMM_NOEXCEPT
+    {
+        return _m_data->profiler.enabled() ? detail::entry_of(fn) : 0;
+    }
+
+    // Construct context of ctx running f. If entry is not 0, its stack is
+    // profiled, and sized from the profile unless size is specified other
+    // than default one.
+    template <typename F>
+    void
+    _m_make_context(context_type &ctx, F f, size_type size, const void *entry) const
+    {
+        if (entry && size == detail::ctx::default_stacksize())
+        {
+            size = _m_data->profiler.size_for(entry, size);
+        }
+        typedef typename scheduler_data::stack_pool_type stack_pool_type;
+        detail::context(
+          f, size, detail::pooled_stack_allocator<stack_pool_type>(_m_data->stacks, entry != 0)
+        ).swap(fusion::at_c<0>(ctx));
+        fusion::at_c<4>(ctx).entry = entry;
+    }
+
+    template <typename R, typename Fn, typename Arg>
+    void
+    _m_spawn_into(contexts_type &ctxs, future_group<R, allocator_type> &fs
+    , Fn &fn, Arg &arg)
+    {
+        context_type ctx;
+        BOOST_MMM_THREAD_FUTURE<R> f;
+        _m_make_context(ctx,
+          make_starter(phoenix::bind(fn, arg), f)
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));
+        fs.push_back(boost::move(f));
+        ctxs.push(boost::move(ctx));
+    }
+
+    template <typename R, typename Fn>
+    void
+    _m_spawn_into(contexts_type &ctxs, future_group<R, allocator_type> &fs, Fn &fn)
+    {
+        context_type ctx;
+        BOOST_MMM_THREAD_FUTURE<R> f;
+        _m_make_context(ctx,
+          make_starter(phoenix::bind(fn), f)
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));
+        fs.push_back(boost::move(f));
+        ctxs.push(boost::move(ctx));
     }
 
-    // To run context should call start(). However, cannot get informations
-    // about the context was started.
-    template <typename R, typename = void>
+    // Calls bound function of context and sets result to the promise, whose
+    // future is taken by spawner before the context is entered first.
+    template <typename R, typename Bound>
     struct context_starter;
 
-    template <typename T>
-    static BOOST_MMM_THREAD_FUTURE<T>
-    start_context(context_type &ctx)
+    // Constructs context_starter in place on the stack of the context, so
+    // that the promise is neither copied nor allocated apart.
+    template <typename R, typename Bound>
+    struct starter_factory : public typed_in_place_factory_base
     {
-        using namespace detail;
+        typedef context_starter<R, Bound> value_type;
 
-        current_context::set_current_ctx(&ctx);
-        BOOST_MMM_THREAD_FUTURE<T> f(reinterpret_cast<promise<T> *>(fusion::at_c<0>(ctx).jump())->get_future());
-        current_context::set_current_ctx(0);
-        return boost::move(f);
+        starter_factory(const Bound &bound, BOOST_MMM_THREAD_FUTURE<R> &future)
+          : _m_bound(boost::addressof(bound)), _m_future(&future) {}
+
+        void
+        apply(void *address) const
+        {
+            new (address) value_type(*_m_bound, *_m_future);
+        }
+
+    private:
+        const Bound                *_m_bound;
+        BOOST_MMM_THREAD_FUTURE<R> *_m_future;
+    }; // template struct starter_factory
+
+    // f receives the future when the context is made.
+    template <typename R, typename Bound>
+    static starter_factory<R, Bound>
+    make_starter(const Bound &bound, BOOST_MMM_THREAD_FUTURE<R> &f)
+    {
+        return starter_factory<R, Bound>(bound, f);
+    }
+
+    // Strategies might shed a context before its function is called. Others
+    // never look up the current context here.
+    static bool
+    is_shed()
+    {
+        if (!may_shed<strategy_traits>::value) { return false; }
+        const detail::context_tuple *ctx = detail::current_context::get_current_ctx();
+        return ctx && fusion::at_c<4>(*ctx).shed;
     }
 
     void
     _m_construct_thread_pool(const int default_count)
     {
         BOOST_ASSERT(_m_data);
+        add_kernels(static_cast<size_type>(default_count));
+    }
 
-        for (int cnt = 0; cnt < default_count; ++cnt)
-        {
-            thread th(&scheduler::_m_exec, boost::ref(*this), boost::ref(*_m_data));
+    // Must be called with resize_mtx.
+    void
+    _m_start_kernel()
+    {
+        typedef void (*exec_type)(scheduler_data &, kernel_type &);
+
+        unique_lock<mutex> guard(_m_data->mtx);
+        // New kernel waits for the lock before looking for contexts, so it
+        // can be activated after launching.
+        kernel_type &kernel = _m_data->locals.acquire();
+        thread th(static_cast<exec_type>(&scheduler::_m_exec)
+        , boost::ref(*_m_data), boost::ref(kernel));
+        kernel.activate(th.get_id());
+        _m_bind_kernel(kernel, th);
 
 #if !defined(BOOST_MMM_CONTAINER_BREAKING_EMPLACE_RETURN_TYPE)
-            std::pair<typename kernels_type::iterator, bool> r =
+        std::pair<typename kernels_type::iterator, bool> r =
 #endif
-            _m_data->kernels.emplace(th.get_id(), boost::move(th));
+        _m_data->kernels.emplace(th.get_id(), boost::move(th));
 #if !defined(BOOST_MMM_CONTAINER_BREAKING_EMPLACE_RETURN_TYPE)
-            BOOST_ASSERT(r.second);
-            BOOST_MMM_DETAIL_UNUSED(r);
+        BOOST_ASSERT(r.second);
+        BOOST_MMM_DETAIL_UNUSED(r);
 #endif
+    }
+
+    // Must be called with resize_mtx.
+    void
+    _m_bind_kernel(kernel_type &kernel, thread &th)
+    {
+        const typename scheduler_data::cpus_type &cpus = _m_data->cpus;
+        if (cpus.empty()) { return; }
+
+        const detail::cpu_info &cpu = cpus[kernel.index() % cpus.size()];
+        if (detail::bind_to_cpu(th, cpu.cpu)) { kernel.locate(cpu); }
+    }
+
+    // Retire one kernel other than the calling one and wait for its exit.
+    // Must be called with resize_mtx.
+    bool
+    _m_stop_kernel()
+    {
+        const typename scheduler_data::locals_type::view locals = _m_data->locals.get_view();
+        kernel_type *self = _m_data->current_kernel.get();
+
+        kernel_type *kernel = 0;
+        thread th;
+        {
+            unique_lock<mutex> guard(_m_data->mtx);
+            if (_m_data->kernels.size() < 2) { return false; }
+
+            // Prefer later kernels so that indices stay dense.
+            for (size_type i = locals.size(); i-- && !kernel;)
+            {
+                if (locals[i].is_active() && &locals[i] != self) { kernel = &locals[i]; }
+            }
+            if (!kernel) { return false; }
+
+            kernel->retire();
+            typename kernels_type::iterator itr = _m_data->kernels.find(kernel->thread_id());
+            BOOST_ASSERT(itr != _m_data->kernels.end());
+            th = boost::move(itr->second);
+            _m_data->kernels.erase(itr);
+        }
+        // Cannot wake up only the retiring one; others will park again.
+        _m_data->idle.notify_all();
+        th.join();
+
+        unique_lock<mutex> guard(_m_data->mtx);
+        kernel->deactivate();
+        return true;
+    }
+
+    void
+    _m_start_monitor()
+    {
+        thread(&scheduler::_m_monitor, boost::ref(*this), _m_data->scaling).swap(_m_data->monitor);
+    }
+
+    void
+    _m_monitor(scaling_policy policy)
+    {
+        size_type idle_samples = 0;
+        for (;;)
+        {
+            // Interrupted by disable_auto_scaling.
+            detail::this_thread::sleep_for(policy.interval);
+            boost::this_thread::disable_interruption di;
+
+            const size_type kernels = kernel_size();
+            const size_type depth = user_size();
+
+            if (kernels < policy.min_kernels
+              || (kernels < policy.max_kernels && kernels * policy.grow_threshold < depth))
+            {
+                add_kernels(1);
+                idle_samples = 0;
+            }
+            else if (!depth && _m_data->idle.parked() && policy.min_kernels < kernels)
+            {
+                if (policy.shrink_samples <= ++idle_samples)
+                {
+                    remove_kernels(1);
+                    idle_samples = 0;
+                }
+            }
+            else
+            {
+                idle_samples = 0;
+            }
         }
-#if defined(BOOST_MMM_CONTAINER_BREAKING_EMPLACE_RETURN_TYPE)
-        BOOST_ASSERT(_m_data->kernels.size() == default_count);
-#endif
     }
 #endif
 
 public:
     /**
      * <b>Effects</b>: Move internal scheduler datas from the other. And the
-     * other becomes <i>not-in-scheduling</i>.
+     * other becomes <i>not-in-scheduling</i>. Auto-scaling is stopped while
+     * moving, and restarted for *this if enabled.
      *
-     * <b>Throws</b>: Nothing.
+     * <b>Throws</b>: boost::thread_resource_error: if restarting auto-scaling
+     * failed, then auto-scaling is disabled.
      */
-    scheduler(BOOST_RV_REF(scheduler) other) BOOST_MMM_NOEXCEPT
-      : _m_data(boost::move(other._m_data)) {}
+    scheduler(BOOST_RV_REF(scheduler) other)
+    {
+        if (!other._m_data) { return; }
+
+        // The monitor calls members of the other. Kernels and the poller
+        // refer to scheduler_data only, so keep running while moving.
+        const bool scaling = other._m_data->monitor.joinable();
+        other.disable_auto_scaling();
+
+        _m_data = boost::move(other._m_data);
+
+        if (scaling) { _m_start_monitor(); }
+    }
 
     /**
      * <b>Effects</b>: Construct with specified count <i>kernel-threads</i>
@@ -317,9 +1307,10 @@ public:
             BOOST_THROW_EXCEPTION(invalid_argument("default_count should be > 0"));
         }
 
-        // XXX: Should use specified allocator.
         // Defer initializing.
-        _m_data.reset(new scheduler_data(scheduler_traits(*this), poll_TO));
+        detail::allocation_guard<scheduler_data, allocator_type> guard;
+        ::new (guard.get()) scheduler_data(poll_TO);
+        _m_data.reset(guard.release());
         _m_construct_thread_pool(default_count);
     }
 
@@ -340,7 +1331,9 @@ public:
             BOOST_THROW_EXCEPTION(invalid_argument("default_count should be > 0"));
         }
 
-        _m_data.reset(new scheduler_data(noasyncpool));
+        detail::allocation_guard<scheduler_data, allocator_type> guard;
+        ::new (guard.get()) scheduler_data(noasyncpool);
+        _m_data.reset(guard.release());
         _m_construct_thread_pool(default_count);
     }
 
@@ -356,11 +1349,13 @@ public:
 
         if (joinable()) { std::terminate(); }
 
+        disable_auto_scaling();
+
         {
             unique_lock<mutex> guard(_m_data->mtx);
             _m_data->status |= _st_terminate;
-            _m_data->cond.notify_all();
         }
+        _m_data->idle.notify_all();
 
         typedef typename kernels_type::iterator iterator;
         typedef typename kernels_type::const_iterator const_iterator;
@@ -379,19 +1374,66 @@ public:
     BOOST_PP_ENUM_BINARY_PARAMS(n_, typename remove_reference<T_, >::type BOOST_PP_INTERCEPT)
 #define BOOST_MMM_scheduler_add_thread(unused_z_, n_, unused_data_)         \
     template <typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)>  \
-    typename disable_if<                                                    \
-      is_same<size_type, Fn>                                                \
-    , BOOST_MMM_THREAD_FUTURE<typename result_of<typename remove_reference<Fn>::type(BOOST_PP_ENUM_PARAMS(n_, Arg))>::type> >::type \
+    typename lazy_disable_if<                                               \
+      is_add_thread_option<Fn>                                              \
+    , future_of<typename remove_reference<Fn>::type(BOOST_PP_ENUM_PARAMS(n_, Arg))> >::type \
     add_thread(Fn fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, arg))    \
     {                                                                       \
         BOOST_ASSERT(_m_data);                                              \
         return add_thread<Fn & BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, & BOOST_PP_INTERCEPT)>( \
-          ctx::default_stacksize()                                          \
+          detail::ctx::default_stacksize()                                  \
         , fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, arg));                       \
     }                                                                       \
                                                                             \
     template <typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)>  \
     BOOST_MMM_THREAD_FUTURE<typename result_of<typename remove_reference<Fn>::type(BOOST_MMM_enum_rmref_params(n_, Arg))>::type> \
+    add_thread(detail::kernel_placement where, Fn fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, arg)) \
+    {                                                                       \
+        BOOST_ASSERT(_m_data);                                              \
+                                                                            \
+        typedef typename remove_reference<Fn>::type fn_type;                \
+        typedef typename                                                    \
+          result_of<fn_type(BOOST_MMM_enum_rmref_params(n_, Arg))>::type    \
+        fn_result_type;                                                     \
+                                                                            \
+        context_type ctx;                                                   \
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;                          \
+        _m_make_context(ctx,                                                \
+          make_starter(                                                     \
+            phoenix::bind(fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, arg)), f)    \
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));               \
+                                                                            \
+        _m_push_spawned(boost::move(ctx), where);                           \
+        return boost::move(f);                                              \
+    }                                                                       \
+                                                                            \
+    template <typename Attr, typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)> \
+    typename lazy_enable_if<                                                \
+      detail::is_spawn_attribute<Attr>                                      \
+    , future_of<typename remove_reference<Fn>::type(BOOST_PP_ENUM_PARAMS(n_, Arg))> >::type \
+    add_thread(Attr attr, Fn fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, arg)) \
+    {                                                                       \
+        BOOST_ASSERT(_m_data);                                              \
+                                                                            \
+        typedef typename remove_reference<Fn>::type fn_type;                \
+        typedef typename                                                    \
+          result_of<fn_type(BOOST_MMM_enum_rmref_params(n_, Arg))>::type    \
+        fn_result_type;                                                     \
+                                                                            \
+        context_type ctx;                                                   \
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;                          \
+        _m_make_context(ctx,                                                \
+          make_starter(                                                     \
+            phoenix::bind(fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, arg)), f)    \
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));               \
+        attr.apply(ctx);                                                    \
+                                                                            \
+        _m_push_spawned(boost::move(ctx));                                  \
+        return boost::move(f);                                              \
+    }                                                                       \
+                                                                            \
+    template <typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)>  \
+    BOOST_MMM_THREAD_FUTURE<typename result_of<typename remove_reference<Fn>::type(BOOST_MMM_enum_rmref_params(n_, Arg))>::type> \
     add_thread(size_type size, Fn fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, arg)) \
     {                                                                       \
         BOOST_ASSERT(_m_data);                                              \
@@ -402,16 +1444,13 @@ public:
         fn_result_type;                                                     \
                                                                             \
         context_type ctx;                                                   \
-        detail::context(                                                    \
-          phoenix::bind(                                                    \
-            context_starter<fn_result_type>(ctx)                            \
-          , fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, arg))                      \
-        , size).swap(fusion::at_c<0>(ctx));                                 \
-        BOOST_MMM_THREAD_FUTURE<fn_result_type> f = start_context<fn_result_type>(ctx); \
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;                          \
+        _m_make_context(ctx,                                                \
+          make_starter(                                                     \
+            phoenix::bind(fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, arg)), f)    \
+        , size, _m_entry_of(fn));                                           \
                                                                             \
-        unique_lock<mutex> guard(_m_data->mtx);                             \
-        strategy_traits().push_ctx(scheduler_traits(*this), move(ctx));     \
-        _m_data->cond.notify_one();                                         \
+        _m_push_spawned(boost::move(ctx));                                  \
         return boost::move(f);                                              \
     }                                                                       \
 // BOOST_MMM_scheduler_add_thread
@@ -431,16 +1470,16 @@ public:
      */
     template <typename Fn, typename... Args>
 #if !defined(BOOST_MMM_DOXYGEN_INVOKED)
-    typename disable_if<
-      is_same<size_type, Fn>
-    , BOOST_MMM_THREAD_FUTURE<typename result_of<typename remove_reference<Fn>::type(Args...)>::type> >::type
+    typename lazy_disable_if<
+      is_add_thread_option<Fn>
+    , future_of<typename remove_reference<Fn>::type(Args...)> >::type
 #else
     future<typename result_of<Fn(Args...)>::type>
 #endif
     add_thread(Fn fn, Args... args)
     {
         BOOST_ASSERT(_m_data);
-        using ctx::default_stacksize;
+        using detail::ctx::default_stacksize;
         return add_thread<Fn &, Args &...>(default_stacksize(), fn, args...);
     }
 
@@ -470,27 +1509,164 @@ public:
         fn_result_type;
 
         context_type ctx;
-        detail::context(
-          phoenix::bind(context_starter<fn_result_type>(ctx), fn, args...)
-        , size).swap(fusion::at_c<0>(ctx));
-        BOOST_MMM_THREAD_FUTURE<fn_result_type> f = start_context<fn_result_type>(ctx);
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;
+        _m_make_context(ctx,
+          make_starter(phoenix::bind(fn, args...), f)
+        , size, _m_entry_of(fn));
 
-        unique_lock<mutex> guard(_m_data->mtx);
-        strategy_traits().push_ctx(scheduler_traits(*this), boost::move(ctx));
-        _m_data->cond.notify_one();
+        _m_push_spawned(boost::move(ctx));
+
+        return boost::move(f);
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Construct context pinned to the <i>kernel-thread</i>
+     * specified by on_kernel, and join to scheduling with default stack
+     * size. The context is unpinned if the <i>kernel-thread</i> is not
+     * running.
+     *
+     * <b>Returns</b>: An object of future<typename result_of<Fn(Args...)>::type>.
+     *
+     * <b>Requires</b>: All of functor and arguments are <b>CopyConstructible</b>.
+     */
+    template <typename Fn, typename... Args>
+#if !defined(BOOST_MMM_DOXYGEN_INVOKED)
+    BOOST_MMM_THREAD_FUTURE<typename result_of<typename remove_reference<Fn>::type(typename remove_reference<Args>::type...)>::type>
+#else
+    future<typename result_of<Fn(Args...)>::type>
+#endif
+    add_thread(detail::kernel_placement where, Fn fn, Args... args)
+    {
+        BOOST_ASSERT(_m_data);
+
+        typedef typename remove_reference<Fn>::type fn_type;
+        typedef typename
+          result_of<fn_type(typename remove_reference<Args>::type...)>::type
+        fn_result_type;
+
+        context_type ctx;
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;
+        _m_make_context(ctx,
+          make_starter(phoenix::bind(fn, args...), f)
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));
+
+        _m_push_spawned(boost::move(ctx), where);
+
+        return boost::move(f);
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Construct context with attribute such as with_priority,
+     * and join to scheduling with default stack size.
+     *
+     * <b>Returns</b>: An object of future<typename result_of<Fn(Args...)>::type>.
+     *
+     * <b>Requires</b>: All of functor and arguments are <b>CopyConstructible</b>.
+     */
+    template <typename Attr, typename Fn, typename... Args>
+#if !defined(BOOST_MMM_DOXYGEN_INVOKED)
+    typename lazy_enable_if<
+      detail::is_spawn_attribute<Attr>
+    , future_of<typename remove_reference<Fn>::type(typename remove_reference<Args>::type...)> >::type
+#else
+    future<typename result_of<Fn(Args...)>::type>
+#endif
+    add_thread(Attr attr, Fn fn, Args... args)
+    {
+        BOOST_ASSERT(_m_data);
+
+        typedef typename remove_reference<Fn>::type fn_type;
+        typedef typename
+          result_of<fn_type(typename remove_reference<Args>::type...)>::type
+        fn_result_type;
+
+        context_type ctx;
+        BOOST_MMM_THREAD_FUTURE<fn_result_type> f;
+        _m_make_context(ctx,
+          make_starter(phoenix::bind(fn, args...), f)
+        , detail::ctx::default_stacksize(), _m_entry_of(fn));
+        attr.apply(ctx);
+
+        _m_push_spawned(boost::move(ctx));
 
         return boost::move(f);
     }
 #endif
 
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Construct contexts which call fn(*itr) for each itr in
+     * [first, last) and join them to scheduling at once with default stack
+     * size.
+     *
+     * <b>Returns</b>: A future_group of futures in same order as the range.
+     *
+     * <b>Requires</b>: Fn and value type of InputIterator are
+     * <b>CopyConstructible</b>.
+     */
+    template <typename InputIterator, typename Fn>
+    future_group<
+      typename result_of<Fn(typename iterator_value<InputIterator>::type)>::type
+    , allocator_type>
+    add_threads(InputIterator first, InputIterator last, Fn fn)
+    {
+        BOOST_ASSERT(_m_data);
+
+        typedef typename iterator_value<InputIterator>::type value_type;
+        typedef typename result_of<Fn(value_type)>::type fn_result_type;
+
+        contexts_type ctxs;
+        future_group<fn_result_type, allocator_type> fs;
+        for (; first != last; ++first)
+        {
+            value_type v = *first;
+            _m_spawn_into<fn_result_type>(ctxs, fs, fn, v);
+        }
+        _m_push_spawned(ctxs);
+
+        return boost::move(fs);
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Construct n contexts which call fn() and join them to
+     * scheduling at once with default stack size.
+     *
+     * <b>Returns</b>: A future_group of n futures.
+     *
+     * <b>Requires</b>: Fn is <b>CopyConstructible</b>.
+     */
+    template <typename Fn>
+    future_group<typename result_of<Fn()>::type, allocator_type>
+    add_threads(size_type n, Fn fn)
+    {
+        BOOST_ASSERT(_m_data);
+
+        typedef typename result_of<Fn()>::type fn_result_type;
+
+        contexts_type ctxs;
+        future_group<fn_result_type, allocator_type> fs;
+        while (n--)
+        {
+            _m_spawn_into<fn_result_type>(ctxs, fs, fn);
+        }
+        _m_push_spawned(ctxs);
+
+        return boost::move(fs);
+    }
+
 private:
 #if !defined(BOOST_MMM_DOXYGEN_INVOKED)
     bool
     joinable_nolock() const BOOST_MMM_NOEXCEPT
     {
-        return _m_data->users.size() != 0
-          || _m_data->runnings != 0
-          || (_m_data->async_pool && _m_data->async_pool->joinable());
+        return _m_data->lives != 0;
     }
 #endif
 public:
@@ -509,10 +1685,13 @@ public:
         BOOST_ASSERT(_m_data);
         unique_lock<mutex> guard(_m_data->mtx);
 
+        // status should be set before checking lives; kernel-threads decrement
+        // lives without lock.
+        _m_data->status |= _st_join;
         while (joinable_nolock())
         {
+            _m_data->join_cond.wait(guard);
             _m_data->status |= _st_join;
-            _m_data->cond.wait(guard);
         }
         _m_data->status &= ~_st_join;
     }
@@ -551,7 +1730,193 @@ public:
     /**
      * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
      *
-     * <b>Returns</b>: Number of <i>user-threads</i>.
+     * <b>Effects</b>: Launch n more <i>kernel-threads</i>.
+     *
+     * <b>Returns</b>: Number of <i>kernel-threads</i> after launching.
+     *
+     * <b>Throws</b>: boost::thread_resource_error if failed to launch. Already
+     * launched ones are kept.
+     */
+    size_type
+    add_kernels(size_type n)
+    {
+        BOOST_ASSERT(_m_data);
+        lock_guard<mutex> guard(_m_data->resize_mtx);
+        while (n--)
+        {
+            _m_start_kernel();
+        }
+        return kernel_size();
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Stop at most n <i>kernel-threads</i>, keeping at least
+     * one. Each of them finishes running <i>user-thread</i> and hands over
+     * its queued <i>user-threads</i> to others before exit. Blocks until they
+     * exit. When called from a <i>user-thread</i>, the calling
+     * <i>kernel-thread</i> is never stopped.
+     *
+     * <b>Returns</b>: Number of stopped <i>kernel-threads</i>.
+     */
+    size_type
+    remove_kernels(size_type n)
+    {
+        BOOST_ASSERT(_m_data);
+        lock_guard<mutex> guard(_m_data->resize_mtx);
+        size_type removed = 0;
+        for (; removed < n && _m_stop_kernel(); ++removed);
+        return removed;
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Pin each <i>kernel-thread</i>, including ones added
+     * later, to a CPU following policy. The topology is read from /sys.
+     *
+     * <b>Returns</b>: false iff CPU topology is not available or no CPU is
+     * usable. Then <i>kernel-threads</i> are left as they are.
+     */
+    bool
+    place_kernels(const placement_policy &policy = placement_policy())
+    {
+        BOOST_ASSERT(_m_data);
+        lock_guard<mutex> resize_guard(_m_data->resize_mtx);
+
+        typename scheduler_data::cpus_type cpus;
+        if (!detail::read_cpu_topology(policy.cpus, cpus) || cpus.empty())
+        {
+            return false;
+        }
+        _m_data->cpus.swap(cpus);
+
+        const typename scheduler_data::locals_type::view locals = _m_data->locals.get_view();
+        unique_lock<mutex> guard(_m_data->mtx);
+        for (size_type i = 0; i < locals.size(); ++i)
+        {
+            if (!locals[i].is_active()) { continue; }
+
+            typename kernels_type::iterator itr = _m_data->kernels.find(locals[i].thread_id());
+            BOOST_ASSERT(itr != _m_data->kernels.end());
+            _m_bind_kernel(locals[i], itr->second);
+        }
+        return true;
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>, and not
+     * called from a <i>user-thread</i>.
+     *
+     * <b>Effects</b>: Start adjusting number of <i>kernel-threads</i> within
+     * [policy.min_kernels, policy.max_kernels] by run-queue depth and idle
+     * <i>kernel-threads</i>. Replaces previous policy if enabled.
+     */
+    void
+    enable_auto_scaling(const scaling_policy &policy = scaling_policy())
+    {
+        BOOST_ASSERT(_m_data);
+        BOOST_ASSERT(0 < policy.min_kernels && policy.min_kernels <= policy.max_kernels);
+
+        disable_auto_scaling();
+        _m_data->scaling = policy;
+        _m_start_monitor();
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>, and not
+     * called from a <i>user-thread</i>.
+     *
+     * <b>Effects</b>: Stop adjusting number of <i>kernel-threads</i>. Current
+     * number is kept.
+     */
+    void
+    disable_auto_scaling()
+    {
+        BOOST_ASSERT(_m_data);
+        if (!_m_data->monitor.joinable()) { return; }
+        _m_data->monitor.interrupt();
+        _m_data->monitor.join();
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Cache at most high_water stacks of completed
+     * <i>user-threads</i> for each size class, to be reused by spawning.
+     * Pages of cached ones beyond resident are released to OS, keeping
+     * their mappings. Excess ones are freed or released immediately.
+     */
+    void
+    set_stack_cache(size_type high_water, size_type resident)
+    {
+        BOOST_ASSERT(_m_data);
+        _m_data->stacks.set_limits(high_water, resident);
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Release pages of all of cached stacks to OS, e.g. under
+     * memory pressure. Their mappings are kept to be reused.
+     */
+    void
+    trim_stack_cache()
+    {
+        BOOST_ASSERT(_m_data);
+        _m_data->stacks.trim();
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Fill stacks of <i>user-threads</i> spawned after this
+     * with canary, and record depth of them used when completed, for each
+     * entry function. Ones spawned with default stack size get stacks sized
+     * from the records, as specified by policy.
+     */
+    void
+    enable_stack_profiling(const stack_sizing_policy &policy = stack_sizing_policy())
+    {
+        BOOST_ASSERT(_m_data);
+        _m_data->profiler.enable(policy);
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Effects</b>: Stop profiling and sizing stacks of ones spawned after
+     * this. Records are kept.
+     */
+    void
+    disable_stack_profiling()
+    {
+        BOOST_ASSERT(_m_data);
+        _m_data->profiler.disable();
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Returns</b>: Stack usage of completed <i>user-threads</i> spawned
+     * with fn. Functions are told apart by address, and function objects
+     * by type.
+     */
+    template <typename Fn>
+    stack_profile
+    get_stack_profile(Fn fn) const
+    {
+        BOOST_ASSERT(_m_data);
+        return _m_data->profiler.profile_of(detail::entry_of(fn), detail::ctx::default_stacksize());
+    }
+
+    /**
+     * <b>Precondition</b>: *this is not <i>not-in-scheduling</i>.
+     *
+     * <b>Returns</b>: Number of <i>user-threads</i> which are waiting for
+     * execution, includes ones in local deques and mailboxes of
+     * <i>kernel-threads</i>.
      *
      * <b>Throws</b>: Nothing.
      */
@@ -559,14 +1924,21 @@ public:
     user_size() const BOOST_MMM_NOEXCEPT
     {
         BOOST_ASSERT(_m_data);
+
+        const typename scheduler_data::locals_type::view locals = _m_data->locals.get_view();
+        size_type mailed = 0;
+        for (size_type i = 0; i < locals.size(); ++i)
+        {
+            mailed += locals[i].mailed();
+        }
+
         unique_lock<mutex> guard(_m_data->mtx);
-        return _m_data->users.size();
+        return _m_data->users.size() + _m_data->queued + mailed;
     }
 
 private:
-    // XXX: Should use specified allocator.
     typedef
-      interprocess::unique_ptr<scheduler_data, checked_deleter<scheduler_data> >
+      interprocess::unique_ptr<scheduler_data, detail::allocator_deleter<scheduler_data, allocator_type> >
     scheduler_data_ptr;
 
     scheduler_data_ptr _m_data;
@@ -574,81 +1946,61 @@ private:
 
 #if !defined(BOOST_MMM_DOXYGEN_INVOKED)
 template <typename Strategy, typename Allocator>
-template <typename R, typename>
+template <typename R, typename Bound>
 struct scheduler<Strategy, Allocator>::context_starter
 {
     typedef void result_type;
 
-    typedef typename scheduler<Strategy, Allocator>::context_type context_type;
-    reference_wrapper<context_type> _m_ctx;
-
-    explicit
-    context_starter(context_type &ctx)
-      : _m_ctx(ctx) {}
+    // Shared state is allocated by allocator_type if supported.
+    context_starter(const Bound &bound, BOOST_MMM_THREAD_FUTURE<R> &future)
+      : _m_bound(bound)
+#if defined(BOOST_MMM_THREAD_FUTURE_USES_ALLOCATORS)
+      , _m_promise(boost::allocator_arg, allocator_type())
+#endif
+    {
+        BOOST_MMM_THREAD_FUTURE<R> f(_m_promise.get_future());
+        future = boost::move(f);
+    }
 
-#if defined(BOOST_NO_VARIADIC_TEMPLATES)
-#define BOOST_MMM_context_starter_op_call(unused_z_, n_, unused_data_)  \
-    template <typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)> \
-    void                                                                \
-    operator()(Fn &fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, &arg)) const \
-    {                                                                   \
-        promise<R> p;                                                   \
-        fusion::at_c<0>(unwrap_ref(_m_ctx)).jump(&p);                   \
-        p.set_value(fn(BOOST_PP_ENUM_PARAMS(n_, arg)));                 \
-    }                                                                   \
-// BOOST_MMM_context_starter_op_call
-    BOOST_PP_REPEAT(BOOST_PP_INC(BOOST_MMM_SCHEDULER_MAX_ARITY), BOOST_MMM_context_starter_op_call, ~)
-#undef BOOST_MMM_context_starter_op_call
-#else
-    template <typename Fn, typename... Args>
     void
-    operator()(Fn &fn, Args &... args) const
+    operator()()
     {
-        promise<R> p;
-        fusion::at_c<0>(unwrap_ref(_m_ctx)).jump(&p);
-        p.set_value(fn(args...));
+        if (is_shed()) { _m_promise.set_exception(copy_exception(deadline_missed())); return; }
+        _m_promise.set_value(_m_bound());
     }
-#endif
+
+private:
+    Bound      _m_bound;
+    promise<R> _m_promise;
 }; // template struct scheduler::context_starter
 
 template <typename Strategy, typename Allocator>
-template <typename Dummy>
-struct scheduler<Strategy, Allocator>::context_starter<void, Dummy>
+template <typename Bound>
+struct scheduler<Strategy, Allocator>::context_starter<void, Bound>
 {
     typedef void result_type;
 
-    typedef typename scheduler<Strategy, Allocator>::context_type context_type;
-    reference_wrapper<context_type> _m_ctx;
-
-    explicit
-    context_starter(context_type &ctx)
-      : _m_ctx(ctx) {}
+    context_starter(const Bound &bound, BOOST_MMM_THREAD_FUTURE<void> &future)
+      : _m_bound(bound)
+#if defined(BOOST_MMM_THREAD_FUTURE_USES_ALLOCATORS)
+      , _m_promise(boost::allocator_arg, allocator_type())
+#endif
+    {
+        BOOST_MMM_THREAD_FUTURE<void> f(_m_promise.get_future());
+        future = boost::move(f);
+    }
 
-#if defined(BOOST_NO_VARIADIC_TEMPLATES)
-#define BOOST_MMM_context_starter_op_call(unused_z_, n_, unused_data_)  \
-    template <typename Fn BOOST_PP_ENUM_TRAILING_PARAMS(n_, typename Arg)> \
-    void                                                                \
-    operator()(Fn &fn BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n_, Arg, &arg)) const \
-    {                                                                   \
-        promise<void> p;                                                \
-        fusion::at_c<0>(unwrap_ref(_m_ctx)).jump(&p);                   \
-        fn(BOOST_PP_ENUM_PARAMS(n_, arg));                              \
-        p.set_value();                                                  \
-    }                                                                   \
-// BOOST_MMM_context_starter_op_call
-    BOOST_PP_REPEAT(BOOST_PP_INC(BOOST_MMM_SCHEDULER_MAX_ARITY), BOOST_MMM_context_starter_op_call, ~)
-#undef BOOST_MMM_context_starter_op_call
-#else
-    template <typename Fn, typename... Args>
     void
-    operator()(Fn &fn, Args &... args) const
+    operator()()
     {
-        promise<void> p;
-        fusion::at_c<0>(unwrap_ref(_m_ctx)).jump(&p);
-        fn(args...);
-        p.set_value();
+        if (is_shed()) { _m_promise.set_exception(copy_exception(deadline_missed())); return; }
+        _m_bound();
+        _m_promise.set_value();
     }
-#endif
+
+private:
+    Bound         _m_bound;
+    promise<void> _m_promise;
 }; // template struct scheduler::context_starter
 #endif
 
@@ -9,25 +9,38 @@
 #include <boost/config.hpp>
 #include <boost/detail/workaround.hpp>
 
-#include <boost/ref.hpp>
 #include <boost/assert.hpp>
 
+#include <boost/chrono/duration.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/mmm/detail/thread/locks.hpp>
 
 namespace boost { namespace mmm {
 
+// Refers to internal data of the scheduler, not to the scheduler itself,
+// so that kernel-threads and the poller keep working after it is moved.
 template <typename Scheduler>
 struct scheduler_traits
 {
     typedef Scheduler scheduler_type;
 
+#if !defined(BOOST_MMM_DOXYGEN_INVOKED)
+    typedef typename scheduler_type::scheduler_data _data_type;
+#endif
+
     /**
      * <b>Effects</b>: No effects.
      */
     explicit
     scheduler_traits(scheduler_type &sch)
-      : _m_scheduler(sch) {}
+      : _m_data(sch._m_data.get()) {}
+
+    /**
+     * <b>Effects</b>: No effects.
+     */
+    explicit
+    scheduler_traits(_data_type &data)
+      : _m_data(&data) {}
 
     /**
      * <b>Precondition</b>: scheduler is not <i>not-in-scheduling</i>.
@@ -37,8 +50,8 @@ struct scheduler_traits
     typename scheduler_type::strategy_traits::pool_type &
     pool() const BOOST_MMM_NOEXCEPT
     {
-        BOOST_ASSERT(_m_scheduler.get()._m_data);
-        return _m_scheduler.get()._m_data->users;
+        BOOST_ASSERT(_m_data);
+        return _m_data->users;
     }
 
     /**
@@ -49,25 +62,64 @@ struct scheduler_traits
     unique_lock<mutex>
     get_lock() const
     {
-        return unique_lock<mutex>(_m_scheduler.get()._m_data->mtx);
+        return unique_lock<mutex>(_m_data->mtx);
     }
 
     /**
-     * <b>Effects</b>: Notify all suspended scheduler threads without lock.
+     * <b>Effects</b>: Wake up all idle scheduler threads. Issues a system call
+     * only if any of them is parked.
      */
     void
     notify_all() const
     {
-        _m_scheduler.get()._m_data->cond.notify_all();
+        _m_data->idle.notify_all();
     }
 
     /**
-     * <b>Effects</b>: Notify a suspended scheduler thread without lock.
+     * <b>Effects</b>: Wake up an idle scheduler thread. Issues a system call
+     * only if any of them is parked.
      */
     void
     notify_one() const
     {
-        _m_scheduler.get()._m_data->cond.notify_one();
+        _m_data->idle.notify_one();
+    }
+
+    /**
+     * <b>Precondition</b>: Called with lock.
+     *
+     * <b>Effects</b>: Hand ctx to the <i>kernel-thread</i> which ran it last,
+     * if it is pinned or the <i>kernel-thread</i> is not busy.
+     *
+     * <b>Returns</b>: true iff ctx was taken. Otherwise, ctx should be pushed
+     * to pool.
+     */
+    template <typename Context>
+    bool
+    push_affine(Context &ctx) const
+    {
+        return scheduler_type::_m_push_affine(*_m_data, ctx);
+    }
+
+    /**
+     * <b>Effects</b>: Resume sleeping contexts whose deadline has been
+     * reached. Must be called without lock.
+     */
+    void
+    expire_timers() const
+    {
+        scheduler_type::_m_expire_timers(*_m_data);
+    }
+
+    /**
+     * <b>Returns</b>: Shorter one of timeout and time until the earliest
+     * deadline of sleeping contexts.
+     */
+    template <typename Rep, typename Period>
+    chrono::nanoseconds
+    timer_timeout(chrono::duration<Rep, Period> timeout) const
+    {
+        return scheduler_type::_m_timer_timeout(*_m_data, timeout);
     }
 
     /**
@@ -79,10 +131,10 @@ struct scheduler_traits
     unique_lock<mutex>
     get_lock(const LockType &lt) const
     {
-        return unique_lock<mutex>(_m_scheduler.get()._m_data->mtx, lt);
+        return unique_lock<mutex>(_m_data->mtx, lt);
     }
 private:
-    boost::reference_wrapper<scheduler_type> _m_scheduler;
+    _data_type *_m_data;
 }; // template struct scheduler_traits
 
 } } // namespace boost::mmm
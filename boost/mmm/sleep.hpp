@@ -0,0 +1,76 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_SLEEP_HPP
+#define BOOST_MMM_SLEEP_HPP
+
+#include <boost/chrono/duration.hpp>
+#include <boost/chrono/time_point.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/current_context.hpp>
+#include <boost/mmm/detail/thread/sleep.hpp>
+
+#include <boost/fusion/include/at.hpp>
+
+namespace boost { namespace mmm { namespace this_ctx {
+
+/**
+ * <b>Effects</b>: Suspend current context until abs_time. The context does
+ * not occupy any kernel-thread while sleeping, and is queued to the strategy
+ * again after abs_time. Blocks current thread instead if current context is
+ * not controlled under scheduler.
+ */
+template <typename Duration>
+inline void
+sleep_until(const chrono::time_point<chrono::steady_clock, Duration> &abs_time)
+{
+    using namespace detail::current_context;
+    detail::context_tuple *ctx_tuple = get_current_ctx();
+    if (!ctx_tuple)
+    {
+        const chrono::steady_clock::duration rest = abs_time - chrono::steady_clock::now();
+        if (rest > chrono::steady_clock::duration::zero())
+        {
+            detail::this_thread::sleep_for(rest);
+        }
+        return;
+    }
+
+    detail::context_timer &timer = fusion::at_c<3>(*ctx_tuple);
+    timer.deadline =
+      chrono::time_point_cast<chrono::steady_clock::duration>(abs_time);
+    timer.armed = true;
+    fusion::at_c<0>(*ctx_tuple).jump();
+}
+
+/**
+ * <b>Effects</b>: Same as sleep_until(steady_clock::now() + (abs_time -
+ * Clock::now())), since sleeping contexts are ordered by steady_clock.
+ */
+template <typename Clock, typename Duration>
+inline void
+sleep_until(const chrono::time_point<Clock, Duration> &abs_time)
+{
+    sleep_until(chrono::steady_clock::now()
+      + chrono::duration_cast<chrono::steady_clock::duration>(abs_time - Clock::now()));
+}
+
+/**
+ * <b>Effects</b>: Suspend current context for at least rel_time, see
+ * sleep_until.
+ */
+template <typename Rep, typename Period>
+inline void
+sleep_for(const chrono::duration<Rep, Period> &rel_time)
+{
+    sleep_until(chrono::steady_clock::now()
+      + chrono::duration_cast<chrono::steady_clock::duration>(rel_time));
+}
+
+} } } // namespace boost::mmm::this_ctx
+
+#endif
@@ -0,0 +1,55 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STACK_PROFILE_HPP
+#define BOOST_MMM_STACK_PROFILE_HPP
+
+#include <cstddef>
+#include <boost/config.hpp>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+
+namespace boost { namespace mmm {
+
+/**
+ * Parameters of stack profiling. Once min_samples <i>user-threads</i> of an
+ * entry function have completed, later ones spawned without stack size get
+ * the deepest usage observed plus headroom percent of it, rounded up to
+ * pages and limited to [min_size, max_size].
+ */
+struct stack_sizing_policy
+{
+    typedef std::size_t size_type;
+
+    // 0 to only profile, without sizing.
+    size_type min_samples;
+    size_type headroom;
+    size_type min_size;
+    size_type max_size;
+
+    stack_sizing_policy()
+      : min_samples(16), headroom(50)
+      , min_size(detail::ctx::minimum_stacksize()), max_size(detail::ctx::default_stacksize()) {}
+}; // struct stack_sizing_policy
+
+/**
+ * Stack usage of completed <i>user-threads</i> of an entry function.
+ */
+struct stack_profile
+{
+    typedef std::size_t size_type;
+
+    size_type samples;
+    // Bytes of stack used, the deepest and on average.
+    size_type max_used;
+    size_type mean_used;
+    // Stack size for next spawn, default one if not sized yet.
+    size_type stack_size;
+}; // struct stack_profile
+
+} } // namespace boost::mmm
+
+#endif
@@ -10,6 +10,12 @@
 
 #include <boost/mmm/strategy_traits.hpp>
 #include <boost/mmm/strategy/fifo.hpp>
+#include <boost/mmm/strategy/work_stealing.hpp>
+#include <boost/mmm/strategy/priority.hpp>
+#include <boost/mmm/strategy/edf.hpp>
+#include <boost/mmm/strategy/mlfq.hpp>
+#include <boost/mmm/strategy/fair_share.hpp>
+#include <boost/mmm/strategy/lock_free_fifo.hpp>
+#include <boost/mmm/strategy/locked.hpp>
 
 #endif
-
@@ -0,0 +1,181 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_EDF_HPP
+#define BOOST_MMM_STRATEGY_EDF_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/container/vector.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/context_node.hpp>
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Earliest deadline first. Contexts of earlier deadline are resumed first,
+ * and ones of same deadline in FIFO order. If Shedding, a context whose
+ * deadline has passed before its function is called is completed without
+ * calling it, and its future holds deadline_missed.
+ */
+template <bool Shedding = false>
+struct edf {}; // template struct edf
+
+} // namespace boost::mmm::strategy
+
+namespace detail {
+
+// Binary heap of contexts ordered by deadline. Contexts are parked into hooks
+// so that heap operations only copy trivial entries.
+template <typename Context, typename Allocator>
+class deadline_heap
+{
+    typedef context_node<Context> node;
+    typedef typename node::pointer pointer;
+    typedef chrono::steady_clock::time_point time_point;
+
+    struct entry_type
+    {
+        time_point      deadline;
+        boost::uint64_t sequence;
+        pointer         ctx;
+    }; // struct entry_type
+
+    // Makes std::*_heap a min-heap.
+    struct later
+    {
+        bool
+        operator()(const entry_type &l, const entry_type &r) const BOOST_MMM_NOEXCEPT
+        {
+            return l.deadline != r.deadline ? r.deadline < l.deadline : r.sequence < l.sequence;
+        }
+    }; // struct later
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(entry_type)
+    entry_alloc_type;
+    typedef container::vector<entry_type, entry_alloc_type> entries_type;
+
+public:
+    typedef Context value_type;
+    typedef std::size_t size_type;
+
+    deadline_heap()
+      : _m_sequence(0) {}
+
+    ~deadline_heap()
+    {
+        BOOST_ASSERT(_m_entries.empty());
+    }
+
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_entries.size();
+    }
+
+    void
+    push(const time_point &deadline, BOOST_RV_REF(Context) ctx)
+    {
+        const entry_type e = { deadline, _m_sequence++, node::create(boost::move(ctx)) };
+        _m_entries.push_back(e);
+        std::push_heap(_m_entries.begin(), _m_entries.end(), later());
+    }
+
+    /**
+     * <b>Precondition</b>: size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the earliest deadline into ctx.
+     */
+    void
+    pop(Context &ctx)
+    {
+        BOOST_ASSERT(size());
+        std::pop_heap(_m_entries.begin(), _m_entries.end(), later());
+        node::release(_m_entries.back().ctx, ctx);
+        _m_entries.pop_back();
+    }
+
+private:
+    entries_type    _m_entries;
+    boost::uint64_t _m_sequence;
+}; // template class deadline_heap
+
+} // namespace boost::mmm::detail
+
+template <bool Shedding, typename Context, typename Allocator>
+struct strategy_traits<strategy::edf<Shedding>, Context, Allocator>
+{
+    typedef Context context_type;
+
+    typedef detail::deadline_heap<context_type, Allocator> pool_type;
+
+    /**
+     * <b>Precondition</b>: traits.pool().size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the earliest deadline from context
+     * pool. If Shedding, it is marked as shed when its deadline has passed.
+     *
+     * <b>Returns</b>: A context which is not a <i>not-a-context</i>.
+     */
+    template <typename SchedulerTraits>
+    context_type
+    pop_ctx(SchedulerTraits traits)
+    {
+        pool_type &pool = traits.pool();
+        BOOST_ASSERT(pool.size());
+
+        context_type ctx;
+        pool.pop(ctx);
+        if (Shedding)
+        {
+            detail::context_attributes &attrs = fusion::at_c<4>(ctx);
+            attrs.shed = attrs.deadline < chrono::steady_clock::now();
+        }
+        return boost::move(ctx);
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to context pool.
+     */
+    template <typename SchedulerTraits>
+    void
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        using fusion::at_c;
+        BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
+        pool_type &pool = traits.pool();
+
+        pool.push(at_c<4>(ctx).deadline, boost::move(ctx));
+    }
+}; // template struct strategy_traits<strategy::edf<S>, C, A>
+
+template <bool Shedding, typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::edf<Shedding>, Context, Allocator> >
+  : public mpl::true_ {};
+
+template <bool Shedding, typename Context, typename Allocator>
+struct may_shed<
+  strategy_traits<strategy::edf<Shedding>, Context, Allocator> >
+  : public mpl::bool_<Shedding> {};
+
+} } // namespace boost::mmm
+
+#endif
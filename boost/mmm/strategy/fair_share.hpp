@@ -0,0 +1,305 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_FAIR_SHARE_HPP
+#define BOOST_MMM_STRATEGY_FAIR_SHARE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+#include <boost/chrono/duration.hpp>
+
+#include <boost/container/list.hpp>
+#include <boost/container/map.hpp>
+#include <boost/container/set.hpp>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/scheduler_traits.hpp>
+#include <boost/mmm/detail/context.hpp>
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Weighted fair share across groups of contexts. Each group has a virtual
+ * runtime, which advances by run time of its contexts divided by its weight,
+ * and a context of the group most behind is resumed first. Contexts of a
+ * group are resumed in FIFO order.
+ */
+struct fair_share {}; // struct fair_share
+
+} // namespace boost::mmm::strategy
+
+namespace detail {
+
+// Contexts queued per group, and runnable groups ordered by virtual runtime.
+// Selecting a group takes O(log groups).
+template <typename Context, typename Allocator>
+class fair_share_pool : private noncopyable
+{
+    typedef boost::uint64_t vruntime_type;
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(Context)
+    context_alloc_type;
+
+    struct group_type
+    {
+        group_type(unsigned weight, vruntime_type vruntime)
+          : weight(weight), vruntime(vruntime) {}
+
+        container::list<Context, context_alloc_type> contexts;
+        unsigned      weight;
+        vruntime_type vruntime;
+    }; // struct group_type
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(group_type)
+    group_alloc_type;
+
+    typedef std::pair<const std::size_t, group_type *> group_entry;
+    typedef container::map<
+      std::size_t, group_type *, std::less<std::size_t>
+    , typename BOOST_MMM_ALLOCATOR_REBIND(Allocator)(group_entry)>
+    groups_type;
+
+    typedef std::pair<vruntime_type, std::size_t> runnable_entry;
+    typedef container::set<
+      runnable_entry, std::less<runnable_entry>
+    , typename BOOST_MMM_ALLOCATOR_REBIND(Allocator)(runnable_entry)>
+    runnable_type;
+
+    group_type &
+    get_group(std::size_t id)
+    {
+        typename groups_type::iterator itr = _m_groups.find(id);
+        if (itr != _m_groups.end()) { return *itr->second; }
+
+        group_type *g = group_alloc_type().allocate(1);
+        ::new (static_cast<void *>(g)) group_type(default_weight, _m_min_vruntime);
+        _m_groups.insert(group_entry(id, g));
+        return *g;
+    }
+
+    void
+    release_group(typename groups_type::iterator itr)
+    {
+        group_type *g = itr->second;
+        _m_groups.erase(itr);
+        g->~group_type();
+        group_alloc_type().deallocate(g, 1);
+    }
+
+public:
+    typedef Context value_type;
+    typedef std::size_t size_type;
+
+    // Same as nice 0 of CFS.
+    BOOST_STATIC_CONSTEXPR unsigned default_weight = 1024;
+
+    fair_share_pool()
+      : _m_size(0), _m_min_vruntime(0) {}
+
+    ~fair_share_pool()
+    {
+        BOOST_ASSERT(!_m_size);
+        while (!_m_groups.empty()) { release_group(_m_groups.begin()); }
+    }
+
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_size;
+    }
+
+    /**
+     * <b>Effects</b>: Advance virtual runtime of group by ran, divided by
+     * its weight.
+     */
+    template <typename Rep, typename Period>
+    void
+    charge(std::size_t id, chrono::duration<Rep, Period> ran)
+    {
+        const vruntime_type ns = chrono::duration_cast<chrono::nanoseconds>(ran).count();
+        if (!ns) { return; }
+
+        group_type &g = get_group(id);
+        const vruntime_type delta = ns * default_weight / g.weight;
+        if (g.contexts.empty())
+        {
+            g.vruntime += delta;
+            return;
+        }
+
+        // Runnable, should be rekeyed.
+        _m_runnable.erase(runnable_entry(g.vruntime, id));
+        g.vruntime += delta;
+        _m_runnable.insert(runnable_entry(g.vruntime, id));
+    }
+
+    void
+    push(std::size_t id, BOOST_RV_REF(Context) ctx)
+    {
+        group_type &g = get_group(id);
+        if (g.contexts.empty())
+        {
+            // Waking group should not take over the time it did not use.
+            if (g.vruntime < _m_min_vruntime) { g.vruntime = _m_min_vruntime; }
+            _m_runnable.insert(runnable_entry(g.vruntime, id));
+        }
+        g.contexts.push_back(boost::move(ctx));
+        ++_m_size;
+    }
+
+    /**
+     * <b>Precondition</b>: size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the group whose virtual runtime is
+     * least into ctx.
+     */
+    void
+    pop(Context &ctx)
+    {
+        BOOST_ASSERT(_m_size);
+        const typename runnable_type::iterator first = _m_runnable.begin();
+        const runnable_entry e = *first;
+        if (_m_min_vruntime < e.first) { _m_min_vruntime = e.first; }
+
+        const typename groups_type::iterator itr = _m_groups.find(e.second);
+        group_type &g = *itr->second;
+        ctx = boost::move(g.contexts.front());
+        g.contexts.pop_front();
+        --_m_size;
+
+        if (!g.contexts.empty()) { return; }
+        _m_runnable.erase(first);
+        // Waking group starts from min vruntime anyway.
+        if (g.weight == default_weight) { release_group(itr); }
+    }
+
+    /**
+     * <b>Requires</b>: weight > 0
+     *
+     * <b>Effects</b>: Set weight of group. Takes effect on run time charged
+     * later.
+     */
+    void
+    set_weight(std::size_t id, unsigned weight)
+    {
+        BOOST_ASSERT(weight);
+        get_group(id).weight = weight;
+    }
+
+private:
+    groups_type   _m_groups;
+    runnable_type _m_runnable;
+    size_type     _m_size;
+    vruntime_type _m_min_vruntime;
+}; // template class fair_share_pool
+
+} // namespace boost::mmm::detail
+
+template <typename Context, typename Allocator>
+struct strategy_traits<strategy::fair_share, Context, Allocator>
+{
+    typedef Context context_type;
+
+    typedef detail::fair_share_pool<context_type, Allocator> pool_type;
+
+    /**
+     * <b>Precondition</b>: traits.pool().size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the group most behind its weighted
+     * share from context pool.
+     *
+     * <b>Returns</b>: A context which is not a <i>not-a-context</i>.
+     */
+    template <typename SchedulerTraits>
+    context_type
+    pop_ctx(SchedulerTraits traits)
+    {
+        pool_type &pool = traits.pool();
+        BOOST_ASSERT(pool.size());
+
+        context_type ctx;
+        pool.pop(ctx);
+        return boost::move(ctx);
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Charge its group for the last run, and push a specified
+     * context to context pool.
+     */
+    template <typename SchedulerTraits>
+    void
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        using fusion::at_c;
+        BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
+        pool_type &pool = traits.pool();
+
+        detail::context_attributes &attrs = at_c<4>(ctx);
+        pool.charge(attrs.group, attrs.ran);
+        // Not to charge again if pushed without running.
+        attrs.ran = attrs.ran.zero();
+        pool.push(attrs.group, boost::move(ctx));
+    }
+
+    /**
+     * <b>Effects</b>: Charge the group of a completed context for its last
+     * run.
+     */
+    template <typename SchedulerTraits>
+    void
+    complete_ctx(SchedulerTraits traits, context_type &ctx)
+    {
+        const detail::context_attributes &attrs = fusion::at_c<4>(ctx);
+        traits.pool().charge(attrs.group, attrs.ran);
+    }
+}; // template struct strategy_traits<strategy::fair_share, C, A>
+
+template <typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::fair_share, Context, Allocator> >
+  : public mpl::true_ {};
+
+template <typename Context, typename Allocator>
+struct measures_run_time<
+  strategy_traits<strategy::fair_share, Context, Allocator> >
+  : public mpl::true_ {};
+
+/**
+ * <b>Precondition</b>: s is not <i>not-in-scheduling</i>, and its strategy is
+ * strategy::fair_share.
+ *
+ * <b>Effects</b>: Set weight of group, relative to default weight 1024 of
+ * others. A group of weight 2048 gets twice as much run time as a group of
+ * default weight, if both have contexts to run.
+ */
+template <typename Scheduler>
+void
+set_group_weight(Scheduler &s, std::size_t group, unsigned weight)
+{
+    scheduler_traits<Scheduler> traits(s);
+    unique_lock<mutex> guard(traits.get_lock());
+    traits.pool().set_weight(group, weight);
+}
+
+} } // namespace boost::mmm
+
+#endif
@@ -13,10 +13,8 @@
 #include <boost/assert.hpp>
 #include <boost/fusion/include/at.hpp>
 
-#include <boost/intrusive/detail/mpl.hpp>
-#include <boost/container/list.hpp>
-
 #include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/context_queue.hpp>
 
 namespace boost { namespace mmm {
 
@@ -31,13 +29,8 @@ struct strategy_traits<strategy::fifo, Context, Allocator>
 {
     typedef Context context_type;
 
-#if !defined(BOOST_MMM_DOXYGEN_INVOKED)
-    typedef typename
-      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(context_type)
-    _allocator_type;
-#endif
-
-    typedef container::list<context_type, _allocator_type> pool_type;
+    // Links contexts through their hooks, not to allocate for each pushing.
+    typedef detail::context_queue<context_type> pool_type;
 
     /**
      * <b>Precondition</b>: traits.pool().size() > 0
@@ -53,10 +46,8 @@ struct strategy_traits<strategy::fifo, Context, Allocator>
         pool_type &pool = traits.pool();
         BOOST_ASSERT(pool.size());
 
-        // Call boost::move via ADL
-        context_type ctx = boost::move(pool.front());
-        pool.pop_front();
-
+        context_type ctx;
+        pool.pop(ctx);
         return boost::move(ctx);
     }
 
@@ -73,8 +64,7 @@ struct strategy_traits<strategy::fifo, Context, Allocator>
         BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
         pool_type &pool = traits.pool();
 
-        // Call boost::move via ADL
-        pool.push_back(boost::move(ctx));
+        pool.push(boost::move(ctx));
     }
 }; // template struct strategy_traits<strategy::fifo, C, A>
 
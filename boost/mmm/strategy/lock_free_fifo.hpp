@@ -0,0 +1,192 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_HPP
+#define BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+#include <boost/container/list.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/context_node.hpp>
+#include <boost/mmm/detail/injection_queue.hpp>
+
+// Capacity of lock-free ring of strategy::lock_free_fifo, should be power of
+// 2. Pushing falls back to locking the overflow list when the ring is full.
+#if !defined(BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_SIZE)
+#   define BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_SIZE 4096
+#endif
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Same order as fifo, but the pool is a lock-free ring which scheduler
+ * pushes to and pops from without its lock.
+ */
+struct lock_free_fifo {}; // struct lock_free_fifo
+
+} // namespace boost::mmm::strategy
+
+namespace detail {
+
+// Bounded lock-free ring of contexts with a locked overflow list. Once the
+// ring has overflowed, pushes go to the list until poppers move them back,
+// so that FIFO order is kept.
+template <typename Context, typename Allocator>
+class lock_free_fifo_pool : private noncopyable
+{
+    typedef context_node<Context> node;
+    typedef typename node::pointer pointer;
+    typedef injection_queue<pointer, Allocator> ring_type;
+
+    typedef typename
+      BOOST_MMM_ALLOCATOR_REBIND(Allocator)(pointer)
+    overflow_alloc_type;
+    typedef container::list<pointer, overflow_alloc_type> overflow_type;
+
+public:
+    typedef Context value_type;
+    typedef std::size_t size_type;
+
+    lock_free_fifo_pool()
+      : _m_ring(BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_SIZE), _m_size(0), _m_overflowed(0) {}
+
+    ~lock_free_fifo_pool()
+    {
+        BOOST_ASSERT(!_m_size);
+    }
+
+    /**
+     * <b>Returns</b>: Number of queued contexts. May be stale if others are
+     * pushing or popping.
+     */
+    size_type
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return _m_size.load(memory_order_relaxed);
+    }
+
+    /**
+     * <b>Effects</b>: Push ctx. May be called by any thread.
+     *
+     * <b>Returns</b>: true iff the pool was empty.
+     */
+    bool
+    push(BOOST_RV_REF(Context) ctx)
+    {
+        pointer p = node::create(boost::move(ctx));
+        // Incremented first, not to be decremented by poppers ahead.
+        const bool first = _m_size.fetch_add(1, memory_order_acq_rel) == 0;
+
+        if (!_m_overflowed.load(memory_order_acquire) && _m_ring.try_push(p))
+        {
+            return first;
+        }
+
+        lock_guard<mutex> guard(_m_mtx);
+        _m_overflow.push_back(p);
+        _m_overflowed.store(_m_overflow.size(), memory_order_release);
+        return first;
+    }
+
+    /**
+     * <b>Effects</b>: Pop the oldest context into ctx without blocking. May
+     * be called by any thread.
+     *
+     * <b>Returns</b>: false iff the pool is empty.
+     */
+    bool
+    try_pop(Context &ctx)
+    {
+        pointer p;
+        if (!_m_ring.try_pop(p))
+        {
+            if (!_m_overflowed.load(memory_order_acquire)) { return false; }
+
+            lock_guard<mutex> guard(_m_mtx);
+            if (_m_overflow.empty()) { return false; }
+            p = _m_overflow.front();
+            _m_overflow.pop_front();
+            // The ring is empty now, refill it in order.
+            while (!_m_overflow.empty() && _m_ring.try_push(_m_overflow.front()))
+            {
+                _m_overflow.pop_front();
+            }
+            _m_overflowed.store(_m_overflow.size(), memory_order_release);
+        }
+
+        _m_size.fetch_sub(1, memory_order_acq_rel);
+        node::release(p, ctx);
+        return true;
+    }
+
+private:
+    ring_type           _m_ring;
+    atomic<size_type>   _m_size;
+    // Size of _m_overflow, to check without lock.
+    atomic<size_type>   _m_overflowed;
+    mutex               _m_mtx;
+    overflow_type       _m_overflow;
+}; // template class lock_free_fifo_pool
+
+} // namespace boost::mmm::detail
+
+template <typename Context, typename Allocator>
+struct strategy_traits<strategy::lock_free_fifo, Context, Allocator>
+{
+    typedef Context context_type;
+
+    typedef detail::lock_free_fifo_pool<context_type, Allocator> pool_type;
+
+    /**
+     * <b>Effects</b>: Pop a context from context pool into ctx, without
+     * blocking.
+     *
+     * <b>Returns</b>: false iff context pool is empty.
+     */
+    template <typename SchedulerTraits>
+    bool
+    try_pop_ctx(SchedulerTraits traits, context_type &ctx)
+    {
+        return traits.pool().try_pop(ctx);
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to context pool.
+     *
+     * <b>Returns</b>: true iff context pool became non-empty.
+     */
+    template <typename SchedulerTraits>
+    bool
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        using fusion::at_c;
+        BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
+        return traits.pool().push(boost::move(ctx));
+    }
+}; // template struct strategy_traits<strategy::lock_free_fifo, C, A>
+
+template <typename Context, typename Allocator>
+struct is_lock_free<
+  strategy_traits<strategy::lock_free_fifo, Context, Allocator> >
+  : public mpl::true_ {};
+
+} } // namespace boost::mmm
+
+#endif
@@ -0,0 +1,196 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_LOCKED_HPP
+#define BOOST_MMM_STRATEGY_LOCKED_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/noncopyable.hpp>
+#include <boost/mpl/bool.hpp>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/mmm/detail/thread/locks.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/strategy/fifo.hpp>
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Adapts Strategy to lock-free strategies. Its pool is guarded by own
+ * mutex instead of the scheduler lock, so that scheduler does not lock
+ * around each of resuming. Strategy should use only pool() of scheduler
+ * traits, and should not be work stealing.
+ */
+template <typename Strategy = fifo>
+struct locked {}; // template struct locked
+
+} // namespace boost::mmm::strategy
+
+namespace detail {
+
+template <typename Pool>
+struct locked_pool : private noncopyable
+{
+    // Passed to the adapted strategy in place of scheduler traits.
+    struct pool_traits
+    {
+        Pool &
+        pool() const BOOST_MMM_NOEXCEPT
+        {
+            return _m_pool;
+        }
+
+        Pool &_m_pool;
+    }; // struct pool_traits
+
+    locked_pool()
+      : count(0) {}
+
+    /**
+     * <b>Returns</b>: Number of queued contexts. May be stale if others are
+     * pushing or popping.
+     */
+    std::size_t
+    size() const BOOST_MMM_NOEXCEPT
+    {
+        return count.load(memory_order_relaxed);
+    }
+
+    pool_traits
+    traits() BOOST_MMM_NOEXCEPT
+    {
+        const pool_traits t = { pool };
+        return t;
+    }
+
+    mutex               mtx;
+    Pool                pool;
+    // Size of pool, to check without lock.
+    atomic<std::size_t> count;
+}; // template struct locked_pool
+
+} // namespace boost::mmm::detail
+
+template <typename Strategy, typename Context, typename Allocator>
+struct strategy_traits<strategy::locked<Strategy>, Context, Allocator>
+{
+#if !defined(BOOST_MMM_DOXYGEN_INVOKED)
+    typedef strategy_traits<Strategy, Context, Allocator> _adapted_type;
+#endif
+
+    typedef Context context_type;
+
+    typedef detail::locked_pool<typename _adapted_type::pool_type> pool_type;
+
+    /**
+     * <b>Effects</b>: Pop a context from pool of Strategy into ctx. Returns
+     * immediately without locking if the pool is empty.
+     *
+     * <b>Returns</b>: false iff context pool is empty.
+     */
+    template <typename SchedulerTraits>
+    bool
+    try_pop_ctx(SchedulerTraits traits, context_type &ctx)
+    {
+        pool_type &pool = traits.pool();
+        if (!pool.size()) { return false; }
+
+        lock_guard<mutex> guard(pool.mtx);
+        if (!pool.pool.size()) { return false; }
+        _adapted_type().pop_ctx(pool.traits()).swap(ctx);
+        pool.count.store(pool.pool.size(), memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to pool of Strategy.
+     *
+     * <b>Returns</b>: true iff context pool became non-empty.
+     */
+    template <typename SchedulerTraits>
+    bool
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        pool_type &pool = traits.pool();
+
+        lock_guard<mutex> guard(pool.mtx);
+        const bool first = !pool.pool.size();
+        _adapted_type().push_ctx(pool.traits(), boost::move(ctx));
+        pool.count.store(pool.pool.size(), memory_order_relaxed);
+        return first;
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to pool of Strategy with info,
+     * if Strategy accepts push_info.
+     *
+     * <b>Returns</b>: true iff context pool became non-empty.
+     */
+    template <typename SchedulerTraits>
+    bool
+    push_ctx(SchedulerTraits traits, context_type ctx, const push_info &info)
+    {
+        pool_type &pool = traits.pool();
+
+        lock_guard<mutex> guard(pool.mtx);
+        const bool first = !pool.pool.size();
+        _adapted_type().push_ctx(pool.traits(), boost::move(ctx), info);
+        pool.count.store(pool.pool.size(), memory_order_relaxed);
+        return first;
+    }
+
+    /**
+     * <b>Effects</b>: Let Strategy account the last run of a completed
+     * context.
+     */
+    template <typename SchedulerTraits>
+    void
+    complete_ctx(SchedulerTraits traits, context_type &ctx)
+    {
+        pool_type &pool = traits.pool();
+
+        lock_guard<mutex> guard(pool.mtx);
+        _adapted_type().complete_ctx(pool.traits(), ctx);
+    }
+}; // template struct strategy_traits<strategy::locked<S>, C, A>
+
+template <typename Strategy, typename Context, typename Allocator>
+struct is_lock_free<
+  strategy_traits<strategy::locked<Strategy>, Context, Allocator> >
+  : public mpl::true_ {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::locked<Strategy>, Context, Allocator> >
+  : public is_ordered<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct accepts_push_info<
+  strategy_traits<strategy::locked<Strategy>, Context, Allocator> >
+  : public accepts_push_info<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct measures_run_time<
+  strategy_traits<strategy::locked<Strategy>, Context, Allocator> >
+  : public measures_run_time<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct may_shed<
+  strategy_traits<strategy::locked<Strategy>, Context, Allocator> >
+  : public may_shed<strategy_traits<Strategy, Context, Allocator> > {};
+
+} } // namespace boost::mmm
+
+#endif
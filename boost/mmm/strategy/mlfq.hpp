@@ -0,0 +1,173 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_MLFQ_HPP
+#define BOOST_MMM_STRATEGY_MLFQ_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/bucket_queue.hpp>
+
+// Time slice of the highest level in microseconds, doubled for each lower
+// level.
+#if !defined(BOOST_MMM_STRATEGY_MLFQ_QUANTUM)
+#   define BOOST_MMM_STRATEGY_MLFQ_QUANTUM 2000
+#endif
+
+// Interval of raising all contexts to the highest level in milliseconds.
+#if !defined(BOOST_MMM_STRATEGY_MLFQ_BOOST_INTERVAL)
+#   define BOOST_MMM_STRATEGY_MLFQ_BOOST_INTERVAL 100
+#endif
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Multi-level feedback queue. Spawned contexts start at the highest level.
+ * A context which has run for its time slice in total is demoted, and one
+ * suspended for I/O or sleeping is promoted. All of contexts are raised to
+ * the highest level periodically, not to starve. Contexts waiting for I/O
+ * polled by <i>kernel-threads</i> are promoted once when suspended, and keep
+ * their levels while polled again.
+ */
+template <std::size_t Levels = 4>
+struct mlfq {}; // template struct mlfq
+
+} // namespace boost::mmm::strategy
+
+namespace detail {
+
+template <typename Context, std::size_t Levels>
+struct mlfq_pool : public bucket_queue<Context, Levels>
+{
+    typedef chrono::steady_clock::time_point time_point;
+
+    mlfq_pool()
+      : epoch(0), boosted(chrono::steady_clock::now()) {}
+
+    // Incremented each time all of contexts are raised.
+    std::size_t epoch;
+    time_point  boosted;
+}; // template struct mlfq_pool
+
+} // namespace boost::mmm::detail
+
+template <std::size_t Levels, typename Context, typename Allocator>
+struct strategy_traits<strategy::mlfq<Levels>, Context, Allocator>
+{
+    typedef Context context_type;
+
+    typedef detail::mlfq_pool<context_type, Levels> pool_type;
+
+    /**
+     * <b>Precondition</b>: traits.pool().size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the highest level from context pool.
+     * Raises all of contexts first if the boost interval has elapsed.
+     *
+     * <b>Returns</b>: A context which is not a <i>not-a-context</i>.
+     */
+    template <typename SchedulerTraits>
+    context_type
+    pop_ctx(SchedulerTraits traits)
+    {
+        pool_type &pool = traits.pool();
+        BOOST_ASSERT(pool.size());
+
+        const typename pool_type::time_point now = chrono::steady_clock::now();
+        if (chrono::milliseconds(BOOST_MMM_STRATEGY_MLFQ_BOOST_INTERVAL) <= now - pool.boosted)
+        {
+            // Contexts out of pool are raised when pushed, see push_ctx.
+            pool.raise_all(Levels - 1);
+            ++pool.epoch;
+            pool.boosted = now;
+        }
+
+        context_type ctx;
+        pool.pop(ctx);
+        return boost::move(ctx);
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to context pool, at the level
+     * determined from how long it ran and why it was suspended.
+     */
+    template <typename SchedulerTraits>
+    void
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        using fusion::at_c;
+        BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
+        pool_type &pool = traits.pool();
+
+        const std::size_t top = Levels - 1;
+        detail::context_attributes &attrs = at_c<4>(ctx);
+        if (attrs.reason == detail::suspension_spawned || attrs.epoch != pool.epoch)
+        {
+            attrs.level = top;
+            attrs.used  = attrs.used.zero();
+            attrs.epoch = pool.epoch;
+        }
+        else if (attrs.reason == detail::suspension_io
+              || attrs.reason == detail::suspension_timer)
+        {
+            if (attrs.level < top) { ++attrs.level; }
+            attrs.used = attrs.used.zero();
+        }
+        else
+        {
+            attrs.used += attrs.ran;
+            if (quantum(attrs.level) <= attrs.used)
+            {
+                if (attrs.level) { --attrs.level; }
+                attrs.used = attrs.used.zero();
+            }
+        }
+        // Not to count again if pushed without running.
+        attrs.ran = attrs.ran.zero();
+
+        pool.push(attrs.level, boost::move(ctx));
+    }
+
+    /**
+     * <b>Effects</b>: No effects.
+     */
+    template <typename SchedulerTraits>
+    void
+    complete_ctx(SchedulerTraits, context_type &) {}
+
+private:
+    static chrono::microseconds
+    quantum(std::size_t level) BOOST_MMM_NOEXCEPT
+    {
+        return chrono::microseconds(
+          static_cast<chrono::microseconds::rep>(BOOST_MMM_STRATEGY_MLFQ_QUANTUM) << (Levels - 1 - level));
+    }
+}; // template struct strategy_traits<strategy::mlfq<L>, C, A>
+
+template <std::size_t Levels, typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::mlfq<Levels>, Context, Allocator> >
+  : public mpl::true_ {};
+
+template <std::size_t Levels, typename Context, typename Allocator>
+struct measures_run_time<
+  strategy_traits<strategy::mlfq<Levels>, Context, Allocator> >
+  : public mpl::true_ {};
+
+} } // namespace boost::mmm
+
+#endif
@@ -0,0 +1,86 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_PRIORITY_HPP
+#define BOOST_MMM_STRATEGY_PRIORITY_HPP
+
+#include <cstddef>
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/assert.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/fusion/include/at.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/detail/bucket_queue.hpp>
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Contexts of higher priority are resumed first, and ones of same priority
+ * in FIFO order. Priorities are clamped into [0, Levels).
+ */
+template <std::size_t Levels = 8>
+struct priority {}; // template struct priority
+
+} // namespace boost::mmm::strategy
+
+template <std::size_t Levels, typename Context, typename Allocator>
+struct strategy_traits<strategy::priority<Levels>, Context, Allocator>
+{
+    typedef Context context_type;
+
+    // Links contexts through their hooks, not to allocate for each pushing.
+    typedef detail::bucket_queue<context_type, Levels> pool_type;
+
+    /**
+     * <b>Precondition</b>: traits.pool().size() > 0
+     *
+     * <b>Effects</b>: Pop a context of the highest priority from context pool.
+     *
+     * <b>Returns</b>: A context which is not a <i>not-a-context</i>.
+     */
+    template <typename SchedulerTraits>
+    context_type
+    pop_ctx(SchedulerTraits traits)
+    {
+        pool_type &pool = traits.pool();
+        BOOST_ASSERT(pool.size());
+
+        context_type ctx;
+        pool.pop(ctx);
+        return boost::move(ctx);
+    }
+
+    /**
+     * <b>Precondition</b>: ctx is not a <i>not-a-context</i>, !ctx.is_completed()
+     *
+     * <b>Effects</b>: Push a specified context to context pool.
+     */
+    template <typename SchedulerTraits>
+    void
+    push_ctx(SchedulerTraits traits, context_type ctx)
+    {
+        using fusion::at_c;
+        BOOST_ASSERT(at_c<0>(ctx) && !at_c<0>(ctx).is_complete());
+        pool_type &pool = traits.pool();
+
+        const int p = at_c<4>(ctx).priority;
+        const std::size_t level =
+          p < 0 ? 0 : Levels <= static_cast<std::size_t>(p) ? Levels - 1 : p;
+        pool.push(level, boost::move(ctx));
+    }
+}; // template struct strategy_traits<strategy::priority<L>, C, A>
+
+template <std::size_t Levels, typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::priority<Levels>, Context, Allocator> >
+  : public mpl::true_ {};
+
+} } // namespace boost::mmm
+
+#endif
@@ -0,0 +1,68 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef BOOST_MMM_STRATEGY_WORK_STEALING_HPP
+#define BOOST_MMM_STRATEGY_WORK_STEALING_HPP
+
+#include <boost/mmm/detail/workaround.hpp>
+
+#include <boost/mpl/bool.hpp>
+
+#include <boost/mmm/strategy_traits.hpp>
+#include <boost/mmm/strategy/fifo.hpp>
+
+namespace boost { namespace mmm {
+
+namespace strategy {
+
+/**
+ * Each <i>kernel-thread</i> owns a local deque. Contexts spawned or yielded
+ * on a <i>kernel-thread</i> go to its local deque (LIFO for the owner, FIFO
+ * for thieves). The pool of Strategy is used as shared queue for contexts
+ * which come from outside of <i>kernel-threads</i>. If Strategy is ordered,
+ * all contexts go to its pool, so that they are not resumed out of order.
+ */
+template <typename Strategy = fifo>
+struct work_stealing {}; // template struct work_stealing
+
+} // namespace boost::mmm::strategy
+
+template <typename Strategy, typename Context, typename Allocator>
+struct strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator>
+  : public strategy_traits<Strategy, Context, Allocator> {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct is_work_stealing<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public mpl::true_ {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct is_ordered<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public is_ordered<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct is_lock_free<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public is_lock_free<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct accepts_push_info<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public accepts_push_info<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct measures_run_time<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public measures_run_time<strategy_traits<Strategy, Context, Allocator> > {};
+
+template <typename Strategy, typename Context, typename Allocator>
+struct may_shed<
+  strategy_traits<strategy::work_stealing<Strategy>, Context, Allocator> >
+  : public may_shed<strategy_traits<Strategy, Context, Allocator> > {};
+
+} } // namespace boost::mmm
+
+#endif
@@ -6,11 +6,84 @@
 #ifndef BOOST_MMM_STRATEGY_TRAITS_HPP
 #define BOOST_MMM_STRATEGY_TRAITS_HPP
 
+#include <boost/mpl/bool.hpp>
+#include <boost/chrono/system_clocks.hpp>
+
+#include <boost/mmm/detail/context.hpp>
+
 namespace boost { namespace mmm {
 
 template <typename Strategy, typename Context, typename Allocator>
 struct strategy_traits {}; // template struct strategy_traits
 
+/**
+ * Metafunction: true iff scheduler should keep per <i>kernel-thread</i>
+ * local deques in front of the strategy's pool.
+ */
+template <typename StrategyTraits>
+struct is_work_stealing : public mpl::false_ {}; // template struct is_work_stealing
+
+/**
+ * Metafunction: true iff the strategy orders contexts by their attributes,
+ * so that scheduler should not resume spawned contexts ahead of others via
+ * run-next slot, nor unpinned contexts woken by I/O or timers via mailboxes
+ * of kernel-threads.
+ */
+template <typename StrategyTraits>
+struct is_ordered : public mpl::false_ {}; // template struct is_ordered
+
+/**
+ * Metafunction: true iff scheduler should measure how long a context ran
+ * each time, before pushing it to the strategy. Such strategies should also
+ * have complete_ctx(traits, ctx), which is called with lock for each
+ * completed context to account its last run.
+ */
+template <typename StrategyTraits>
+struct measures_run_time : public mpl::false_ {}; // template struct measures_run_time
+
+/**
+ * Metafunction: true iff the strategy synchronizes its pool by itself, so
+ * that scheduler calls it without lock. Such strategies should have
+ * try_pop_ctx(traits, ctx&), which stores a context into ctx and returns
+ * true or returns false if the pool is empty without blocking, and
+ * push_ctx(traits, ctx), which returns true iff the pool became non-empty.
+ * Both of them and pool_type::size() may be called concurrently.
+ */
+template <typename StrategyTraits>
+struct is_lock_free : public mpl::false_ {}; // template struct is_lock_free
+
+/**
+ * Metafunction: true iff the strategy might mark popped contexts as shed by
+ * context_attributes::shed, so that scheduler completes them without
+ * calling their functions. Otherwise scheduler never looks at the mark.
+ */
+template <typename StrategyTraits>
+struct may_shed : public mpl::false_ {}; // template struct may_shed
+
+/**
+ * Why and when a context is pushed, passed to strategies which accept it.
+ */
+struct push_info
+{
+    typedef chrono::steady_clock::time_point time_point;
+    typedef chrono::steady_clock::duration   duration;
+
+    // Spawned, yielded, I/O became ready, sleep expired or woken.
+    detail::suspension_reason reason;
+    // When pushed.
+    time_point                enqueued;
+    // How long the context ran until suspended, zero if spawned.
+    duration                  ran;
+}; // struct push_info
+
+/**
+ * Metafunction: true iff the strategy has push_ctx(traits, ctx, info), which
+ * scheduler calls with push_info instead of push_ctx(traits, ctx). Scheduler
+ * measures how long a context ran for such strategies.
+ */
+template <typename StrategyTraits>
+struct accepts_push_info : public mpl::false_ {}; // template struct accepts_push_info
+
 #if !defined(BOOST_MMM_DOXYGEN_INVOKED)
 namespace strategy {} // namespace boost::mmm::strategy
 #endif
@@ -18,4 +91,3 @@ namespace strategy {} // namespace boost::mmm::strategy
 } } // namespace boost::mmm
 
 #endif
-
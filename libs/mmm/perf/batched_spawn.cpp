@@ -0,0 +1,50 @@
+// Spawn throughput of a loop of add_thread versus add_threads.
+
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+namespace mmm = boost::mmm;
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler;
+typedef chrono::steady_clock clock_type;
+
+void f() {}
+
+void report(const char *name, int n, clock_type::duration spawn, clock_type::duration total)
+{
+    const double s = chrono::duration_cast<chrono::duration<double> >(spawn).count();
+    const double t = chrono::duration_cast<chrono::duration<double> >(total).count();
+    cout << name << ": "
+         << n / s << " spawns/s, "
+         << n / t << " completions/s" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int n       = 1 < argc ? atoi(argv[1]) : 100000;
+    const int kernels = 2 < argc ? atoi(argv[2]) : 4;
+
+    {
+        scheduler s(kernels, mmm::noasyncpool);
+        const clock_type::time_point start = clock_type::now();
+        for (int i = 0; i < n; ++i) { s.add_thread(f); }
+        const clock_type::time_point spawned = clock_type::now();
+        s.join_all();
+        report("add_thread loop", n, spawned - start, clock_type::now() - start);
+    }
+
+    {
+        scheduler s(kernels, mmm::noasyncpool);
+        const clock_type::time_point start = clock_type::now();
+        mmm::future_group<void> fs = s.add_threads(n, f);
+        const clock_type::time_point spawned = clock_type::now();
+        s.join_all();
+        report("add_threads", n, spawned - start, clock_type::now() - start);
+    }
+}
@@ -0,0 +1,91 @@
+// Spawns per second, page faults and heap allocations per spawn of
+// short-lived contexts, with and without caching their stacks.
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <iostream>
+using namespace std;
+
+#include <sys/resource.h>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+namespace mmm = boost::mmm;
+
+typedef chrono::steady_clock clock_type;
+
+volatile char sink;
+
+// Counts operator new, other than stacks which are mapped or cached.
+boost::atomic<long> allocations(0);
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    if (void *p = malloc(size ? size : 1)) { return p; }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+void handler(int depth)
+{
+    // Touch a few pages of stack as a request handler would.
+    char buf[8 * 1024];
+    memset(buf, depth, sizeof(buf));
+    sink = buf[depth % sizeof(buf)];
+}
+
+long minor_faults()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+void bench(const char *name, int n, int rounds, int kernels
+, size_t high_water, size_t resident)
+{
+    mmm::scheduler<mmm::strategy::fifo> s(kernels, mmm::noasyncpool);
+    s.set_stack_cache(high_water, resident);
+    s.add_threads(n, boost::bind(handler, 1));
+    s.join_all();
+
+    const long before = minor_faults();
+    const long allocated = allocations;
+    const clock_type::time_point start = clock_type::now();
+    for (int i = 0; i < rounds; ++i)
+    {
+        s.add_threads(n, boost::bind(handler, i));
+        s.join_all();
+    }
+    const double t = chrono::duration_cast<chrono::duration<double> >(clock_type::now() - start).count();
+    const long faults = minor_faults() - before;
+    const long news = allocations - allocated;
+
+    const double spawns = static_cast<double>(n) * rounds;
+    cout << name << ": "
+         << spawns / t << " spawns/s, "
+         << faults / spawns << " page faults/spawn, "
+         << news / spawns << " allocations/spawn" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int n       = 1 < argc ? atoi(argv[1]) : 64;
+    const int rounds  = 2 < argc ? atoi(argv[2]) : 1000;
+    const int kernels = 3 < argc ? atoi(argv[3]) : 1;
+
+    bench("uncached", n, rounds, kernels, 0, 0);
+    bench("cached, pages released", n, rounds, kernels, n, 0);
+    bench("cached", n, rounds, kernels, n, n);
+}
@@ -0,0 +1,86 @@
+// Cost of spawning a context and running it to completion, with the first
+// switch running the function directly, against the handshake of earlier
+// spawns which entered the context once to take its promise back.
+
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#include <boost/mmm/detail/stack_utils.hpp>
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+namespace mmm = boost::mmm;
+
+typedef chrono::steady_clock clock_type;
+
+volatile int sink;
+
+struct direct
+{
+    void operator()() const { ++sink; }
+}; // struct direct
+
+// Jumps back to the spawner once before running, as start_context did.
+struct handshake
+{
+    mmm::detail::context *self;
+
+    void operator()() const
+    {
+        self->jump();
+        ++sink;
+    }
+}; // struct handshake
+
+void f() { ++sink; }
+
+void report(const char *name, int n, clock_type::duration d)
+{
+    const double ns = chrono::duration_cast<chrono::duration<double, boost::nano> >(d).count();
+    cout << name << ": " << ns / n << " ns/spawn" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int n = 1 < argc ? atoi(argv[1]) : 100000;
+    const size_t size = ctx::default_stacksize();
+
+    {
+        const clock_type::time_point start = clock_type::now();
+        for (int i = 0; i < n; ++i)
+        {
+            mmm::detail::context c;
+            handshake h = { &c };
+            mmm::detail::context(h, size).swap(c);
+            c.jump();
+            c.jump();
+        }
+        report("context, handshake", n, clock_type::now() - start);
+    }
+
+    {
+        const clock_type::time_point start = clock_type::now();
+        for (int i = 0; i < n; ++i)
+        {
+            mmm::detail::context c(direct(), size);
+            c.jump();
+        }
+        report("context, one switch", n, clock_type::now() - start);
+    }
+
+    // The spawning thread no longer switches into spawned contexts at all.
+    {
+        mmm::scheduler<mmm::strategy::fifo> s(1, mmm::noasyncpool);
+        const clock_type::time_point start = clock_type::now();
+        for (int i = 0; i < n; ++i) { s.add_thread(f); }
+        report("add_thread, spawner", n, clock_type::now() - start);
+        s.join_all();
+        report("add_thread, completed", n, clock_type::now() - start);
+    }
+}
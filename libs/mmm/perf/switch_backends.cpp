@@ -0,0 +1,73 @@
+// Nanoseconds per switch of each context switch backend available, measured
+// by ping-pong between the main thread and a context.
+
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+#include <boost/version.hpp>
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#if !defined(BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU)
+#   define BOOST_MMM_CONTEXT_SWITCH_PRESERVE_FPU 1
+#endif
+#if BOOST_VERSION < 105300
+#include <boost/mmm/detail/context_switch/trunk_fcontext.hpp>
+#endif
+#if 106100 <= BOOST_VERSION
+#include <boost/mmm/detail/context_switch/fcontext.hpp>
+#endif
+#include <boost/mmm/detail/context_switch/ucontext.hpp>
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(__ELF__)
+#define BOOST_MMM_PERF_ASM_SWITCH
+#include <boost/mmm/detail/context_switch/asm.hpp>
+#endif
+namespace detail = boost::mmm::detail;
+
+typedef chrono::steady_clock clock_type;
+
+const size_t stack_size = 64 * 1024;
+
+template <typename Switch>
+void pong(intptr_t v)
+{
+    typename Switch::state &st = *reinterpret_cast<typename Switch::state *>(v);
+    for (;;) { v = Switch::suspend(st, v); }
+}
+
+template <typename Switch>
+void bench(const char *name, int n)
+{
+    char * const stack = static_cast<char *>(malloc(stack_size));
+    typename Switch::state st;
+    Switch::make(st, stack + stack_size, stack_size, &pong<Switch>);
+    Switch::resume(st, reinterpret_cast<intptr_t>(&st));
+
+    const clock_type::time_point start = clock_type::now();
+    intptr_t sum = 0;
+    for (int i = 0; i < n; ++i) { sum += Switch::resume(st, i); }
+    const chrono::nanoseconds t = clock_type::now() - start;
+
+    // The context never completes, just its stack is freed.
+    free(stack);
+    cout << name << ": "
+         << static_cast<double>(t.count()) / (2.0 * n) << " ns/switch"
+         << (sum == static_cast<intptr_t>(n) * (n - 1) / 2 ? "" : " (broken)") << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int n = 1 < argc ? atoi(argv[1]) : 10000000;
+
+#if BOOST_VERSION < 105300
+    bench<detail::trunk_fcontext_switch>("trunk fcontext", n);
+#endif
+#if 106100 <= BOOST_VERSION
+    bench<detail::fcontext_switch>("fcontext", n);
+#endif
+    bench<detail::ucontext_switch>("ucontext", n / 10);
+#if defined(BOOST_MMM_PERF_ASM_SWITCH)
+    bench<detail::asm_switch>("asm", n);
+#endif
+}
@@ -0,0 +1,84 @@
+// Switch latency and dTLB misses per switch with many live contexts, each
+// resumed in turn. Build switch_tlb_arena.cpp to compare with stacks in a
+// huge page arena.
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+typedef chrono::steady_clock clock_type;
+
+boost::atomic<bool> go(false);
+
+// Returns -1 if not permitted.
+int open_dtlb_misses()
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB
+                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.inherit = 1;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+void loop(int m)
+{
+    // Touch the stack as a handler would, on each resuming.
+    volatile char buf[256];
+    while (!go) { mmm::this_ctx::yield(); }
+    for (int i = 0; i < m; ++i)
+    {
+        buf[i % sizeof(buf)] = static_cast<char>(i);
+        mmm::this_ctx::yield();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const int n = 1 < argc ? atoi(argv[1]) : 20000;
+    const int m = 2 < argc ? atoi(argv[2]) : 100;
+
+    mmm::scheduler<mmm::strategy::fifo> s(1, mmm::noasyncpool);
+    const int fd = open_dtlb_misses();
+
+    // Contexts start after all of them are spawned.
+    s.add_threads(n, boost::bind(loop, m));
+    if (0 <= fd) { ioctl(fd, PERF_EVENT_IOC_ENABLE, 0); }
+    const clock_type::time_point start = clock_type::now();
+    go = true;
+    s.join_all();
+    const chrono::nanoseconds t = clock_type::now() - start;
+
+    const double switches = static_cast<double>(n) * m;
+    cout << n << " contexts: " << t.count() / switches << " ns/switch, ";
+    long long misses = 0;
+    if (0 <= fd && read(fd, &misses, sizeof(misses)) == sizeof(misses))
+    {
+        cout << misses / switches << " dTLB misses/switch" << endl;
+    }
+    else
+    {
+        cout << "dTLB misses not available" << endl;
+    }
+}
@@ -0,0 +1,5 @@
+// switch_tlb.cpp with stacks and data of contexts in a huge page arena.
+
+#define BOOST_MMM_STACK_ARENA 1
+
+#include "switch_tlb.cpp"
@@ -0,0 +1,69 @@
+// Context switches per second and heap allocations per switch of contexts
+// yielding in a loop.
+
+#include <cstdlib>
+#include <new>
+#include <iostream>
+using namespace std;
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+namespace chrono = boost::chrono;
+
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+typedef chrono::steady_clock clock_type;
+
+boost::atomic<long> allocations(0);
+
+void *operator new(size_t size) throw(bad_alloc)
+{
+    ++allocations;
+    if (void *p = malloc(size ? size : 1)) { return p; }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) throw()
+{
+    free(p);
+}
+
+void loop(int m)
+{
+    for (int i = 0; i < m; ++i) { mmm::this_ctx::yield(); }
+}
+
+template <typename Strategy>
+void bench(const char *name, int n, int m, int kernels)
+{
+    mmm::scheduler<Strategy> s(kernels, mmm::noasyncpool);
+    // Spawning allocates, so count from when all of contexts are running.
+    s.add_threads(n, boost::bind(loop, 1));
+    s.join_all();
+
+    mmm::future_group<void> fs = s.add_threads(n, boost::bind(loop, m));
+    const long before = allocations;
+    const clock_type::time_point start = clock_type::now();
+    s.join_all();
+    const double t = chrono::duration_cast<chrono::duration<double> >(clock_type::now() - start).count();
+    const long allocated = allocations - before;
+
+    const double switches = static_cast<double>(n) * m;
+    cout << name << ": "
+         << switches / t << " switches/s, "
+         << allocated / switches << " allocations/switch" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const int n       = 1 < argc ? atoi(argv[1]) : 100;
+    const int m       = 2 < argc ? atoi(argv[2]) : 10000;
+    const int kernels = 3 < argc ? atoi(argv[3]) : 1;
+
+    bench<mmm::strategy::fifo>("fifo", n, m, kernels);
+    bench<mmm::strategy::priority<> >("priority", n, m, kernels);
+}
@@ -0,0 +1,128 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+// Assembly context switch, see boost/mmm/detail/context_switch/asm.hpp.
+// Frames pushed here must match ones made by asm_switch::make.
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(__ELF__)
+
+#if defined(__x86_64__)
+
+// rdi: from, rsi: to, rdx: v. rdx is also moved to rdi for the trampoline.
+// Returns by jmp, since ret to another context always mispredicts.
+#define BOOST_MMM_SWITCH_CONTEXT(name_, save_fpu_, restore_fpu_) \
+    ".text\n"                                                   \
+    ".globl " name_ "\n"                                        \
+    ".type " name_ ", @function\n"                              \
+    ".align 16\n"                                               \
+    name_ ":\n"                                                 \
+    "    pushq %rbp\n"                                          \
+    "    pushq %rbx\n"                                          \
+    "    pushq %r15\n"                                          \
+    "    pushq %r14\n"                                          \
+    "    pushq %r13\n"                                          \
+    "    pushq %r12\n"                                          \
+    "    leaq -8(%rsp), %rsp\n"                                 \
+    save_fpu_                                                   \
+    "    movq %rsp, (%rdi)\n"                                   \
+    "    movq %rsi, %rsp\n"                                     \
+    restore_fpu_                                                \
+    "    leaq 8(%rsp), %rsp\n"                                  \
+    "    popq %r12\n"                                           \
+    "    popq %r13\n"                                           \
+    "    popq %r14\n"                                           \
+    "    popq %r15\n"                                           \
+    "    popq %rbx\n"                                           \
+    "    popq %rbp\n"                                           \
+    "    movq %rdx, %rax\n"                                     \
+    "    movq %rdx, %rdi\n"                                     \
+    "    popq %r8\n"                                            \
+    "    jmp *%r8\n"                                            \
+    ".size " name_ ", .-" name_ "\n"
+
+__asm__(
+    BOOST_MMM_SWITCH_CONTEXT("boost_mmm_switch_context"
+    , "    stmxcsr (%rsp)\n"
+      "    fnstcw 4(%rsp)\n"
+    , "    ldmxcsr (%rsp)\n"
+      "    fldcw 4(%rsp)\n")
+    BOOST_MMM_SWITCH_CONTEXT("boost_mmm_switch_context_nofpu", "", "")
+
+    // Entry is in r12, v in rdi. Entry never returns.
+    ".text\n"
+    ".globl boost_mmm_switch_trampoline\n"
+    ".type boost_mmm_switch_trampoline, @function\n"
+    ".align 16\n"
+    "boost_mmm_switch_trampoline:\n"
+    "    andq $-16, %rsp\n"
+    "    callq *%r12\n"
+    "    ud2\n"
+    ".size boost_mmm_switch_trampoline, .-boost_mmm_switch_trampoline\n"
+);
+
+#else // defined(__aarch64__)
+
+// x0: from, x1: to, x2: v. Frame is d8-d15, x19-x30 and FPCR.
+#define BOOST_MMM_SWITCH_CONTEXT(name_, save_fpu_, restore_fpu_) \
+    ".text\n"                                                   \
+    ".globl " name_ "\n"                                        \
+    ".type " name_ ", %function\n"                              \
+    ".align 4\n"                                                \
+    name_ ":\n"                                                 \
+    "    sub sp, sp, #0xb0\n"                                   \
+    "    stp d8, d9, [sp, #0x00]\n"                             \
+    "    stp d10, d11, [sp, #0x10]\n"                           \
+    "    stp d12, d13, [sp, #0x20]\n"                           \
+    "    stp d14, d15, [sp, #0x30]\n"                           \
+    "    stp x19, x20, [sp, #0x40]\n"                           \
+    "    stp x21, x22, [sp, #0x50]\n"                           \
+    "    stp x23, x24, [sp, #0x60]\n"                           \
+    "    stp x25, x26, [sp, #0x70]\n"                           \
+    "    stp x27, x28, [sp, #0x80]\n"                           \
+    "    stp x29, x30, [sp, #0x90]\n"                           \
+    save_fpu_                                                   \
+    "    mov x9, sp\n"                                          \
+    "    str x9, [x0]\n"                                        \
+    "    mov sp, x1\n"                                          \
+    restore_fpu_                                                \
+    "    ldp d8, d9, [sp, #0x00]\n"                             \
+    "    ldp d10, d11, [sp, #0x10]\n"                           \
+    "    ldp d12, d13, [sp, #0x20]\n"                           \
+    "    ldp d14, d15, [sp, #0x30]\n"                           \
+    "    ldp x19, x20, [sp, #0x40]\n"                           \
+    "    ldp x21, x22, [sp, #0x50]\n"                           \
+    "    ldp x23, x24, [sp, #0x60]\n"                           \
+    "    ldp x25, x26, [sp, #0x70]\n"                           \
+    "    ldp x27, x28, [sp, #0x80]\n"                           \
+    "    ldp x29, x30, [sp, #0x90]\n"                           \
+    "    add sp, sp, #0xb0\n"                                   \
+    "    mov x0, x2\n"                                          \
+    "    ret\n"                                                 \
+    ".size " name_ ", .-" name_ "\n"
+
+__asm__(
+    BOOST_MMM_SWITCH_CONTEXT("boost_mmm_switch_context"
+    , "    mrs x9, fpcr\n"
+      "    str x9, [sp, #0xa0]\n"
+    , "    ldr x9, [sp, #0xa0]\n"
+      "    msr fpcr, x9\n")
+    BOOST_MMM_SWITCH_CONTEXT("boost_mmm_switch_context_nofpu", "", "")
+
+    // Entry is in x19, v in x0. Entry never returns.
+    ".text\n"
+    ".globl boost_mmm_switch_trampoline\n"
+    ".type boost_mmm_switch_trampoline, %function\n"
+    ".align 4\n"
+    "boost_mmm_switch_trampoline:\n"
+    "    blr x19\n"
+    "    brk #0\n"
+    ".size boost_mmm_switch_trampoline, .-boost_mmm_switch_trampoline\n"
+);
+
+#endif
+
+#undef BOOST_MMM_SWITCH_CONTEXT
+
+#endif
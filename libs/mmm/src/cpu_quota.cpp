@@ -0,0 +1,59 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+using namespace std;
+
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <boost/mmm/detail/cpu_quota.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+namespace {
+
+// Read "<quota> <period>" from cgroup v2, "max" means unlimited.
+bool
+read_cgroup2_quota(long &quota, long &period)
+{
+    ifstream ifs("/sys/fs/cgroup/cpu.max");
+    string q;
+    if (!(ifs >> q >> period) || q == "max") { return false; }
+    quota = atol(q.c_str());
+    return true;
+}
+
+// Read cfs_quota_us and cfs_period_us from cgroup v1, -1 means unlimited.
+bool
+read_cgroup1_quota(long &quota, long &period)
+{
+    ifstream qfs("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    ifstream pfs("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    return (qfs >> quota) && (pfs >> period) && 0 < quota;
+}
+
+} // anonymous namespace
+
+size_t
+available_concurrency()
+{
+    size_t n = thread::hardware_concurrency();
+    if (!n) { n = 1; }
+
+    long quota, period;
+    if ((read_cgroup2_quota(quota, period) || read_cgroup1_quota(quota, period))
+      && 0 < quota && 0 < period)
+    {
+        const size_t limit = static_cast<size_t>((quota + period - 1) / period);
+        if (limit < n) { n = limit; }
+    }
+    return n;
+}
+
+} } } // namespace boost::mmm::detail
@@ -0,0 +1,214 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/once.hpp>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <boost/mmm/detail/stack_guard.hpp>
+
+// Number of slots of the guard page registry, should be power of 2. The
+// registry is mapped lazily, so that untouched slots take no memory.
+#if !defined(BOOST_MMM_STACK_GUARD_SLOTS)
+#   define BOOST_MMM_STACK_GUARD_SLOTS (1 << 22)
+#endif
+
+namespace boost { namespace mmm { namespace detail {
+
+namespace {
+
+typedef atomic<uintptr_t> slot_type;
+
+// Zero-filled anonymous pages are empty slots as they are.
+BOOST_STATIC_ASSERT(sizeof(slot_type) == sizeof(uintptr_t));
+
+const uintptr_t empty     = 0;
+const uintptr_t tombstone = 1;
+
+once_flag        _installed = BOOST_ONCE_INIT;
+slot_type        *_slots = 0;
+uintptr_t        _page_mask = 0;
+struct sigaction _previous;
+
+size_t
+slot_of(uintptr_t page)
+{
+    uintptr_t h = page >> 12;
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return h & (BOOST_MMM_STACK_GUARD_SLOTS - 1);
+}
+
+// Must be async-signal-safe.
+bool
+is_registered(uintptr_t page)
+{
+    if (!_slots) { return false; }
+
+    size_t i = slot_of(page);
+    for (size_t n = 0; n < BOOST_MMM_STACK_GUARD_SLOTS; ++n)
+    {
+        const uintptr_t v = _slots[i].load(memory_order_acquire);
+        if (v == page) { return true; }
+        if (v == empty) { return false; }
+        i = (i + 1) & (BOOST_MMM_STACK_GUARD_SLOTS - 1);
+    }
+    return false;
+}
+
+// Pass a fault which is not ours to the previous action directly. The
+// process-wide action is kept, since others might have installed theirs.
+void
+chain(int sig, siginfo_t *info, void *uctx)
+{
+    if (_previous.sa_flags & SA_SIGINFO)
+    {
+        _previous.sa_sigaction(sig, info, uctx);
+        return;
+    }
+
+    if (_previous.sa_handler != SIG_DFL && _previous.sa_handler != SIG_IGN)
+    {
+        _previous.sa_handler(sig);
+        return;
+    }
+
+    // Ignoring a fault would loop on it, so both terminate as default. The
+    // signal is blocked while handling, and delivered after return.
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = SIG_DFL;
+    sigemptyset(&sa.sa_mask);
+    sigaction(sig, &sa, 0);
+    raise(sig);
+}
+
+void
+on_segv(int sig, siginfo_t *info, void *uctx)
+{
+    const uintptr_t page = reinterpret_cast<uintptr_t>(info->si_addr) & _page_mask;
+    if (!is_registered(page))
+    {
+        chain(sig, info, uctx);
+        return;
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    char msg[] = "boost.mmm: stack overflow of a user-thread, guard page at 0x"
+                 "0000000000000000\n";
+    char *p = msg + sizeof(msg) - 2;
+    for (uintptr_t v = page; v; v >>= 4) { *--p = digits[v & 0xf]; }
+    const ssize_t r = ::write(STDERR_FILENO, msg, sizeof(msg) - 1);
+    BOOST_MMM_DETAIL_UNUSED(r);
+    abort();
+}
+
+void
+install()
+{
+    _page_mask = ~static_cast<uintptr_t>(sysconf(_SC_PAGESIZE) - 1);
+
+    void * const p = ::mmap(0, BOOST_MMM_STACK_GUARD_SLOTS * sizeof(slot_type)
+    , PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) { return; }
+    _slots = static_cast<slot_type *>(p);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = on_segv;
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGSEGV, &sa, &_previous);
+}
+
+} // anonymous namespace
+
+bool
+register_stack_guard(void *p)
+{
+    call_once(_installed, install);
+    if (!_slots) { return false; }
+
+    const uintptr_t page = reinterpret_cast<uintptr_t>(p);
+    size_t i = slot_of(page);
+    for (size_t n = 0; n < BOOST_MMM_STACK_GUARD_SLOTS; ++n)
+    {
+        uintptr_t v = _slots[i].load(memory_order_relaxed);
+        if ((v == empty || v == tombstone)
+         && _slots[i].compare_exchange_strong(v, page, memory_order_release))
+        {
+            return true;
+        }
+        i = (i + 1) & (BOOST_MMM_STACK_GUARD_SLOTS - 1);
+    }
+    return false;
+}
+
+void
+unregister_stack_guard(void *p)
+{
+    if (!_slots) { return; }
+
+    const uintptr_t page = reinterpret_cast<uintptr_t>(p);
+    size_t i = slot_of(page);
+    for (size_t n = 0; n < BOOST_MMM_STACK_GUARD_SLOTS; ++n)
+    {
+        const uintptr_t v = _slots[i].load(memory_order_relaxed);
+        if (v == empty) { return; }
+        if (v == page)
+        {
+            _slots[i].store(tombstone, memory_order_release);
+            return;
+        }
+        i = (i + 1) & (BOOST_MMM_STACK_GUARD_SLOTS - 1);
+    }
+}
+
+alternate_signal_stack::alternate_signal_stack()
+  : _m_stack(0)
+{
+    if (sigaltstack(0, &_m_old) != 0 || !(_m_old.ss_flags & SS_DISABLE)) { return; }
+
+    // SIGSTKSZ may not be a constant.
+    const size_t minimum = SIGSTKSZ;
+    const size_t size = 64 * 1024 < minimum ? minimum : 64 * 1024;
+    void * const p = ::mmap(0, size, PROT_READ | PROT_WRITE
+    , MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) { return; }
+
+    stack_t ss;
+    ss.ss_sp    = p;
+    ss.ss_size  = size;
+    ss.ss_flags = 0;
+    if (sigaltstack(&ss, 0) != 0)
+    {
+        ::munmap(p, size);
+        return;
+    }
+    _m_stack = p;
+}
+
+alternate_signal_stack::~alternate_signal_stack()
+{
+    if (!_m_stack) { return; }
+
+    stack_t ss;
+    sigaltstack(&_m_old, &ss);
+    ::munmap(_m_stack, ss.ss_size);
+}
+
+} } } // namespace boost::mmm::detail
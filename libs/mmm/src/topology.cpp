@@ -0,0 +1,145 @@
+//          Copyright Kohei Takahashi 2012.
+// Distributed under the Boost Software License, Version 1.0.
+//    (See accompanying file LICENSE_1_0.txt or copy at
+//          http://www.boost.org/LICENSE_1_0.txt)
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include <boost/mmm/detail/workaround.hpp>
+#include <boost/thread/thread.hpp>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <boost/mmm/detail/topology.hpp>
+
+namespace boost { namespace mmm { namespace detail {
+
+namespace {
+
+// Parse list format of sysfs, e.g. "0-3,8,10-11".
+vector<size_t>
+parse_cpu_list(const string &list)
+{
+    vector<size_t> r;
+    const char *p = list.c_str();
+    while (*p)
+    {
+        unsigned long first, last;
+        int n = 0;
+        if (sscanf(p, "%lu-%lu%n", &first, &last, &n) == 2 && n) {}
+        else if (sscanf(p, "%lu%n", &first, &n) == 1 && n) { last = first; }
+        else { break; }
+
+        for (unsigned long i = first; i <= last; ++i) { r.push_back(i); }
+        p += n;
+        if (*p == ',') { ++p; }
+    }
+    return r;
+}
+
+vector<size_t>
+read_cpu_list(const string &path)
+{
+    ifstream ifs(path.c_str());
+    string list;
+    getline(ifs, list);
+    return parse_cpu_list(list);
+}
+
+string
+sys_path(const char *format, size_t n)
+{
+    char buf[128];
+    snprintf(buf, sizeof(buf), format, static_cast<unsigned long>(n));
+    return buf;
+}
+
+struct sibling_rank
+{
+    size_t rank;
+    cpu_info info;
+
+    bool
+    operator<(const sibling_rank &other) const
+    {
+        if (info.node != other.info.node) { return info.node < other.info.node; }
+        if (rank != other.rank) { return rank < other.rank; }
+        return info.cpu < other.info.cpu;
+    }
+}; // struct sibling_rank
+
+} // anonymous namespace
+
+bool
+read_cpu_topology(const vector<size_t> &allowed, vector<cpu_info> &cpus)
+{
+    cpus.clear();
+#if defined(__linux__)
+    const vector<size_t> online = read_cpu_list("/sys/devices/system/cpu/online");
+    if (online.empty()) { return false; }
+
+    vector<size_t> node_of;
+    const vector<size_t> nodes = read_cpu_list("/sys/devices/system/node/online");
+    for (vector<size_t>::const_iterator n = nodes.begin(); n != nodes.end(); ++n)
+    {
+        const vector<size_t> list = read_cpu_list(sys_path("/sys/devices/system/node/node%lu/cpulist", *n));
+        for (vector<size_t>::const_iterator c = list.begin(); c != list.end(); ++c)
+        {
+            if (node_of.size() <= *c) { node_of.resize(*c + 1, cpu_info::unknown); }
+            node_of[*c] = *n;
+        }
+    }
+
+    vector<sibling_rank> ranked;
+    for (vector<size_t>::const_iterator c = online.begin(); c != online.end(); ++c)
+    {
+        if (!allowed.empty() && find(allowed.begin(), allowed.end(), *c) == allowed.end())
+        {
+            continue;
+        }
+
+        const vector<size_t> siblings =
+          read_cpu_list(sys_path("/sys/devices/system/cpu/cpu%lu/topology/thread_siblings_list", *c));
+
+        sibling_rank r;
+        r.info.cpu  = *c;
+        r.info.core = siblings.empty() ? *c : siblings.front();
+        r.info.node = *c < node_of.size() ? node_of[*c] : cpu_info::unknown;
+        r.rank      = find(siblings.begin(), siblings.end(), *c) - siblings.begin();
+        ranked.push_back(r);
+    }
+    sort(ranked.begin(), ranked.end());
+
+    for (vector<sibling_rank>::const_iterator r = ranked.begin(); r != ranked.end(); ++r)
+    {
+        cpus.push_back(r->info);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool
+bind_to_cpu(boost::thread &th, size_t cpu)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return !pthread_setaffinity_np(th.native_handle(), sizeof(set), &set);
+#else
+    return false;
+#endif
+}
+
+} } } // namespace boost::mmm::detail
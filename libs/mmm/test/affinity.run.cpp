@@ -0,0 +1,66 @@
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/affinity.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+boost::atomic<int> moved(0);
+
+// Thread id might be cached by compilers across context switches.
+boost::thread::id (*volatile get_id)() = &boost::this_thread::get_id;
+
+void pinned()
+{
+    const boost::thread::id id = get_id();
+    for (int i = 0; i < 100; ++i)
+    {
+        // Let other kernel-threads run.
+        boost::this_thread::yield();
+        mmm::this_ctx::yield();
+        if (get_id() != id) { ++moved; }
+    }
+}
+
+void pin_self()
+{
+    mmm::this_ctx::pin();
+    pinned();
+    mmm::this_ctx::unpin();
+}
+
+void busy()
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+}
+
+template <typename Strategy>
+void run()
+{
+    mmm::scheduler<Strategy> s(4, mmm::noasyncpool);
+
+    for (int i = 0; i < 16; ++i)
+    {
+        s.add_thread(mmm::on_kernel(i % 4), pinned);
+        s.add_thread(pin_self);
+        s.add_thread(busy);
+    }
+    s.join_all();
+
+    BOOST_REQUIRE(!s.joinable());
+    BOOST_REQUIRE(s.user_size() == 0);
+    BOOST_REQUIRE(moved == 0);
+}
+
+int test_main(int, char **)
+{
+    run<mmm::strategy::fifo>();
+    run<mmm::strategy::work_stealing<> >();
+    return 0;
+}
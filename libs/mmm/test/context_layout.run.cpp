@@ -0,0 +1,98 @@
+#include <stdexcept>
+#include <boost/mmm/detail/stack_utils.hpp>
+#include <boost/mmm/detail/context.hpp>
+namespace mmm = boost::mmm;
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/test/minimal.hpp>
+
+int alive = 0;
+int called = 0;
+int stacks = 0;
+
+template <std::size_t N>
+struct counted
+{
+    counted() { ++alive; }
+    counted(const counted &other)
+      : fail(other.fail)
+    {
+        if (fail) { throw std::runtime_error("copy"); }
+        ++alive;
+    }
+    ~counted() { --alive; }
+
+    void operator()() const { ++called; }
+
+    bool fail;
+    // Stored in data of context if small, or below it on the stack.
+    char pad[N];
+}; // template struct counted
+
+struct counting_allocator
+{
+    void *
+    allocate(std::size_t size) const
+    {
+        ++stacks;
+        return ctx::stack_allocator().allocate(size);
+    }
+
+    void
+    deallocate(void *top, std::size_t size) const
+    {
+        --stacks;
+        ctx::stack_allocator().deallocate(top, size);
+    }
+}; // struct counting_allocator
+
+template <std::size_t N>
+void check()
+{
+    const std::size_t size = ctx::default_stacksize();
+    counted<N> f;
+    f.fail = false;
+
+    // Run to completion.
+    {
+        mmm::detail::context c(f, size, counting_allocator());
+        BOOST_REQUIRE(alive == 2 && stacks == 1);
+        c.jump();
+        BOOST_REQUIRE(c.is_complete());
+        BOOST_REQUIRE(called == 1);
+        // Destroyed by the context when completed.
+        BOOST_REQUIRE(alive == 1);
+    }
+    BOOST_REQUIRE(stacks == 0);
+
+    // Destroyed without being started.
+    {
+        mmm::detail::context c(f, size, counting_allocator());
+        BOOST_REQUIRE(alive == 2);
+    }
+    BOOST_REQUIRE(called == 1);
+    BOOST_REQUIRE(alive == 1 && stacks == 0);
+
+    // Copying function object failed.
+    f.fail = true;
+    bool thrown = false;
+    try
+    {
+        mmm::detail::context c(f, size, counting_allocator());
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    BOOST_REQUIRE(thrown);
+    BOOST_REQUIRE(alive == 1 && stacks == 0);
+
+    called = 0;
+}
+
+int test_main(int, char **)
+{
+    check<1>();
+    check<1024>();
+    return 0;
+}
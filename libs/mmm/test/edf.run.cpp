@@ -0,0 +1,94 @@
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/deadline.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef chrono::steady_clock::time_point time_point;
+
+boost::mutex mtx;
+std::vector<int> finished;
+int calls = 0;
+
+void work(int n)
+{
+    ++calls;
+    for (int i = 0; i < 10; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+    boost::lock_guard<boost::mutex> guard(mtx);
+    finished.push_back(n);
+}
+
+void postpone(int n)
+{
+    // Has the earliest deadline at first.
+    mmm::this_ctx::yield();
+    mmm::this_ctx::set_deadline(mmm::this_ctx::get_deadline() + chrono::minutes(1));
+    work(n);
+}
+
+template <typename Scheduler>
+void spawner(Scheduler *sp, time_point base)
+{
+    Scheduler &s = *sp;
+    // Not resumed until this one completes, since there is one kernel.
+    s.add_thread(mmm::with_deadline(base), postpone, 100);
+    for (int i = 9; 0 <= i; --i)
+    {
+        s.add_thread(mmm::with_deadline(base + chrono::seconds(i + 1)), work, i);
+    }
+    // No deadline, after all of others.
+    s.add_thread(work, 10);
+}
+
+int test_main(int, char **)
+{
+    const time_point base = chrono::steady_clock::now() + chrono::hours(1);
+    {
+        typedef mmm::scheduler<mmm::strategy::edf<> > scheduler_type;
+        scheduler_type s(1, mmm::noasyncpool);
+
+        s.add_thread(spawner<scheduler_type>, &s, base);
+        s.join_all();
+
+        BOOST_REQUIRE(finished.size() == 12);
+        for (int i = 0; i < 10; ++i)
+        {
+            BOOST_REQUIRE(finished[i] == i);
+        }
+        BOOST_REQUIRE(finished[10] == 100);
+        BOOST_REQUIRE(finished[11] == 10);
+    }
+
+    {
+        typedef mmm::scheduler<mmm::strategy::edf<true> > scheduler_type;
+        scheduler_type s(1, mmm::noasyncpool);
+
+        calls = 0;
+        boost::unique_future<void> missed =
+          s.add_thread(mmm::with_deadline(chrono::steady_clock::now() - chrono::seconds(1)), work, 0);
+        boost::unique_future<void> met =
+          s.add_thread(mmm::with_deadline(base), work, 1);
+        s.join_all();
+
+        BOOST_REQUIRE(calls == 1);
+        BOOST_REQUIRE(met.has_value());
+        BOOST_REQUIRE(missed.has_exception());
+        try
+        {
+            missed.get();
+            BOOST_REQUIRE(false);
+        }
+        catch (const mmm::deadline_missed &) {}
+    }
+    return 0;
+}
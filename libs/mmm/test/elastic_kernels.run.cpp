@@ -0,0 +1,65 @@
+#include <boost/atomic.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy/work_stealing.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::work_stealing<> > scheduler;
+
+boost::atomic<int> count(0);
+
+void leaf()
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+    ++count;
+}
+
+void resizer(scheduler *s)
+{
+    // Never removes the calling kernel.
+    s->remove_kernels(8);
+    ++count;
+}
+
+int test_main(int, char **)
+{
+    scheduler s(2, mmm::noasyncpool);
+    BOOST_REQUIRE(s.add_kernels(2) == 4);
+
+    for (int i = 0; i < 500; ++i)
+    {
+        s.add_thread(leaf);
+    }
+    // Retiring kernels hand over their local contexts to others.
+    BOOST_REQUIRE(s.remove_kernels(2) == 2);
+    BOOST_REQUIRE(s.kernel_size() == 2);
+    BOOST_REQUIRE(s.add_kernels(1) == 3);
+    s.join_all();
+    BOOST_REQUIRE(count == 500);
+
+    s.add_thread(resizer, &s);
+    s.join_all();
+    BOOST_REQUIRE(s.kernel_size() == 1);
+    BOOST_REQUIRE(s.remove_kernels(1) == 0);
+
+    mmm::scaling_policy policy(2, 3);
+    policy.interval = boost::chrono::milliseconds(1);
+    s.enable_auto_scaling(policy);
+    for (int i = 0; i < 500; ++i)
+    {
+        s.add_thread(leaf);
+    }
+    s.join_all();
+    s.disable_auto_scaling();
+
+    BOOST_REQUIRE(s.kernel_size() <= 3);
+    BOOST_REQUIRE(!s.joinable());
+    BOOST_REQUIRE(s.user_size() == 0);
+    BOOST_REQUIRE(count == 1001);
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include <boost/atomic.hpp>
+#include <boost/chrono/chrono.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/mmm/detail/eventcount.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+mmm::detail::eventcount ec;
+boost::atomic<bool> stop(false);
+
+// Times out so often that it races with notify.
+void waiter()
+{
+    mmm::detail::parker p;
+    while (!stop)
+    {
+        const mmm::detail::eventcount::key_type key = ec.prepare_wait();
+        ec.commit_wait(p, key, chrono::steady_clock::now() + chrono::microseconds(1));
+    }
+}
+
+int test_main(int, char **)
+{
+    boost::thread_group waiters;
+    for (int i = 0; i < 4; ++i) { waiters.create_thread(waiter); }
+
+    for (int i = 0; i < 1000000; ++i) { ec.notify(1 + i % 3); }
+
+    stop = true;
+    ec.notify_all();
+    waiters.join_all();
+    BOOST_REQUIRE(ec.parked() == 0);
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/group.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fair_share> scheduler_type;
+
+// Only one kernel, not to be raced.
+int slices[4] = {};
+chrono::steady_clock::time_point end;
+
+void spin(std::size_t g)
+{
+    BOOST_REQUIRE(mmm::this_ctx::get_group() == g);
+    while (chrono::steady_clock::now() < end)
+    {
+        const chrono::steady_clock::time_point slice =
+          chrono::steady_clock::now() + chrono::microseconds(200);
+        while (chrono::steady_clock::now() < slice) {}
+        ++slices[g];
+        mmm::this_ctx::yield();
+    }
+}
+
+void spawner(scheduler_type *sp)
+{
+    end = chrono::steady_clock::now() + chrono::milliseconds(300);
+    for (int i = 0; i < 8; ++i)
+    {
+        sp->add_thread(mmm::in_group(1), spin, 1);
+    }
+    sp->add_thread(mmm::in_group(2), spin, 2);
+    sp->add_thread(mmm::in_group(3), spin, 3);
+}
+
+int test_main(int, char **)
+{
+    scheduler_type s(1, mmm::noasyncpool);
+    mmm::set_group_weight(s, 3, 2048);
+
+    s.add_thread(spawner, &s);
+    s.join_all();
+
+    // Shares are 1/4, 1/4 and 1/2 regardless of number of contexts, where
+    // FIFO would give 8/10 to group 1.
+    BOOST_REQUIRE(slices[0] == 0);
+    BOOST_REQUIRE(100 < slices[2]);
+    BOOST_REQUIRE(slices[1] * 4 < slices[2] * 5 && slices[2] * 4 < slices[1] * 5);
+    BOOST_REQUIRE(slices[2] * 8 < slices[3] * 5 && slices[3] * 5 < slices[2] * 12);
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
@@ -0,0 +1,43 @@
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy/fifo.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler;
+
+boost::atomic<int> count(0);
+
+void leaf()
+{
+    mmm::this_ctx::yield();
+    ++count;
+}
+
+void producer(scheduler *s, int n)
+{
+    // More than BOOST_MMM_SCHEDULER_INJECTION_QUEUE_SIZE to exercise fallback.
+    for (int i = 0; i < n; ++i) { s->add_thread(leaf); }
+}
+
+int test_main(int, char **)
+{
+    scheduler s(2, mmm::noasyncpool);
+
+    boost::thread_group producers;
+    for (int i = 0; i < 4; ++i)
+    {
+        producers.create_thread(boost::bind(producer, &s, 2000));
+    }
+    producers.join_all();
+    s.join_all();
+
+    BOOST_REQUIRE(!s.joinable());
+    BOOST_REQUIRE(s.user_size() == 0);
+    BOOST_REQUIRE(count == 4 * 2000);
+    return 0;
+}
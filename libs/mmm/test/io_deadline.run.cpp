@@ -0,0 +1,102 @@
+#include <cerrno>
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/sleep.hpp>
+#include <boost/mmm/io/posix/unistd.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+#include <unistd.h>
+
+typedef chrono::steady_clock::time_point time_point;
+
+boost::atomic<int> timed_out(0);
+boost::atomic<int> early(0);
+boost::atomic<int> received(0);
+
+// Nothing is written to fd, so gives up at the deadline.
+void starving(int fd)
+{
+    const time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(50);
+    char c;
+    if (mmm::io::posix::read(fd, &c, 1, deadline) == -1 && errno == ETIMEDOUT)
+    {
+        ++timed_out;
+    }
+    if (chrono::steady_clock::now() < deadline) { ++early; }
+}
+
+// Written before the deadline, which is cancelled then.
+void fed(int fd)
+{
+    char c;
+    if (mmm::io::posix::read(fd, &c, 1
+          , chrono::steady_clock::now() + chrono::seconds(10)) == 1)
+    {
+        ++received;
+    }
+}
+
+void feeder(int fd)
+{
+    mmm::this_ctx::sleep_for(chrono::milliseconds(20));
+    const char c = 'x';
+    BOOST_REQUIRE(::write(fd, &c, 1) == 1);
+}
+
+template <typename Scheduler>
+void run(Scheduler &s)
+{
+    timed_out = 0;
+    early = 0;
+    received = 0;
+
+    int starved[2], fed_pipe[2];
+    BOOST_REQUIRE(::pipe(starved) == 0);
+    BOOST_REQUIRE(::pipe(fed_pipe) == 0);
+
+    const time_point start = chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) { s.add_thread(starving, starved[0]); }
+    s.add_thread(fed, fed_pipe[0]);
+    s.add_thread(feeder, fed_pipe[1]);
+    s.join_all();
+
+    BOOST_REQUIRE(timed_out == 4);
+    BOOST_REQUIRE(early == 0);
+    BOOST_REQUIRE(received == 1);
+    BOOST_REQUIRE(chrono::steady_clock::now() - start < chrono::seconds(5));
+
+    ::close(starved[0]);
+    ::close(starved[1]);
+    ::close(fed_pipe[0]);
+    ::close(fed_pipe[1]);
+}
+
+int test_main(int, char **)
+{
+    {
+        mmm::scheduler<mmm::strategy::fifo> s(2, chrono::milliseconds(10));
+        run(s);
+    }
+    {
+        // Polled by kernels each time resumed.
+        mmm::scheduler<mmm::strategy::fifo> s(2, mmm::noasyncpool);
+        run(s);
+    }
+
+    // Not controlled under scheduler, polls until the deadline.
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    timed_out = 0;
+    early = 0;
+    starving(fds[0]);
+    BOOST_REQUIRE(timed_out == 1);
+    BOOST_REQUIRE(early == 0);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    return 0;
+}
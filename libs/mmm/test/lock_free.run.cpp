@@ -0,0 +1,107 @@
+// Small enough to overflow the ring.
+#define BOOST_MMM_STRATEGY_LOCK_FREE_FIFO_SIZE 16
+
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/priority.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+boost::atomic<int> count(0);
+
+void leaf()
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+    ++count;
+}
+
+template <typename Scheduler>
+void spawner(Scheduler *s, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        s->add_thread(leaf);
+        mmm::this_ctx::yield();
+    }
+    ++count;
+}
+
+template <typename Scheduler>
+void producer(Scheduler *s, int n)
+{
+    for (int i = 0; i < n; ++i) { s->add_thread(leaf); }
+}
+
+template <typename Strategy>
+void run()
+{
+    typedef mmm::scheduler<Strategy> scheduler_type;
+
+    count = 0;
+    scheduler_type s(4, mmm::noasyncpool);
+
+    boost::thread_group producers;
+    for (int i = 0; i < 2; ++i)
+    {
+        producers.create_thread(boost::bind(producer<scheduler_type>, &s, 500));
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+        s.add_thread(spawner<scheduler_type>, &s, 100);
+    }
+    producers.join_all();
+    s.join_all();
+
+    BOOST_REQUIRE(!s.joinable());
+    BOOST_REQUIRE(s.user_size() == 0);
+    BOOST_REQUIRE(count == 2 * 500 + 8 + 8 * 100);
+}
+
+typedef mmm::scheduler<mmm::strategy::locked<mmm::strategy::priority<> > > priority_scheduler;
+
+std::vector<int> finished;
+
+void work(int p)
+{
+    mmm::this_ctx::yield();
+    // Only one kernel, not to be raced.
+    finished.push_back(p);
+}
+
+void priority_spawner(priority_scheduler *s)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        s->add_thread(work, 0);
+        s->add_thread(mmm::with_priority(5), work, 5);
+    }
+}
+
+int test_main(int, char **)
+{
+    run<mmm::strategy::lock_free_fifo>();
+    run<mmm::strategy::work_stealing<mmm::strategy::lock_free_fifo> >();
+    run<mmm::strategy::locked<> >();
+
+    // Adapted strategy keeps its order.
+    priority_scheduler s(1, mmm::noasyncpool);
+    s.add_thread(priority_spawner, &s);
+    s.join_all();
+
+    BOOST_REQUIRE(finished.size() == 8);
+    for (int i = 0; i < 4; ++i)
+    {
+        BOOST_REQUIRE(finished[i] == 5);
+        BOOST_REQUIRE(finished[4 + i] == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Not to raise hogs during the test.
+#define BOOST_MMM_STRATEGY_MLFQ_BOOST_INTERVAL 60000
+
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/sleep.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::mlfq<> > scheduler_type;
+typedef mmm::scheduler<mmm::strategy::work_stealing<mmm::strategy::mlfq<> > > stealing_scheduler_type;
+
+boost::atomic<int> slices(0);
+boost::atomic<bool> done(false);
+int max_delay = 0;
+
+void hog()
+{
+    while (!done)
+    {
+        const chrono::steady_clock::time_point end =
+          chrono::steady_clock::now() + chrono::milliseconds(2);
+        while (chrono::steady_clock::now() < end) {}
+        ++slices;
+        mmm::this_ctx::yield();
+    }
+}
+
+void interactive()
+{
+    // Let hogs be demoted.
+    while (slices < 64) { mmm::this_ctx::sleep_for(chrono::milliseconds(1)); }
+
+    for (int i = 0; i < 20; ++i)
+    {
+        mmm::this_ctx::sleep_for(chrono::milliseconds(1));
+        const int before = slices;
+        // Resumed ahead of hogs after a short run.
+        mmm::this_ctx::yield();
+        const int delay = slices - before;
+        if (max_delay < delay) { max_delay = delay; }
+    }
+    done = true;
+}
+
+template <typename Scheduler>
+void spawner(Scheduler *sp)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        sp->add_thread(hog);
+    }
+    sp->add_thread(interactive);
+}
+
+template <typename Scheduler>
+void run()
+{
+    slices = 0;
+    done = false;
+    max_delay = 0;
+
+    Scheduler s(1, mmm::noasyncpool);
+
+    s.add_thread(spawner<Scheduler>, &s);
+    s.join_all();
+
+    // FIFO would run all of 8 hogs in between.
+    BOOST_REQUIRE(max_delay <= 1);
+    BOOST_REQUIRE(s.user_size() == 0);
+}
+
+int test_main(int, char **)
+{
+    run<scheduler_type>();
+
+    // Run times are measured and contexts are ordered behind work_stealing
+    // too, so that hogs are demoted.
+    run<stealing_scheduler_type>();
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include <boost/chrono/duration.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/thread/thread.hpp>
 namespace chrono = boost::chrono;
 #include <boost/mmm/scheduler.hpp>
 #include <boost/mmm/strategy/fifo.hpp>
@@ -8,6 +10,8 @@ namespace mmm = boost::mmm;
 
 typedef mmm::scheduler<mmm::strategy::fifo> scheduler;
 
+int twice(int n) { return n * 2; }
+
 scheduler foo()
 {
     scheduler s(1, chrono::milliseconds(10));
@@ -22,6 +26,30 @@ int test_main(int, char **)
 
     scheduler s2 = boost::move(s1);
     BOOST_REQUIRE(s2.kernel_size() == 1);
+
+    // Kernels started before moving run contexts spawned after that, with
+    // and without the poller.
+    BOOST_REQUIRE(s2.add_thread(twice, 21).get() == 42);
+    s2.join_all();
+    {
+        scheduler s4(2, mmm::noasyncpool);
+        scheduler s5 = boost::move(s4);
+        BOOST_REQUIRE(s5.add_thread(twice, 4).get() == 8);
+        s5.join_all();
+    }
+
+    // The monitor follows the moved scheduler, and grows it to min_kernels.
+    mmm::scaling_policy policy(2, 2);
+    policy.interval = chrono::milliseconds(5);
+    s2.enable_auto_scaling(policy);
+    scheduler s3 = boost::move(s2);
+    const chrono::steady_clock::time_point limit =
+      chrono::steady_clock::now() + chrono::seconds(5);
+    while (s3.kernel_size() < 2 && chrono::steady_clock::now() < limit)
+    {
+        boost::this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    BOOST_REQUIRE(s3.kernel_size() == 2);
     return 0;
 }
 
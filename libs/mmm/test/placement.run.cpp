@@ -0,0 +1,46 @@
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy/work_stealing.hpp>
+#include <boost/mmm/placement_policy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::work_stealing<> > scheduler;
+
+boost::atomic<int> count(0);
+
+void leaf()
+{
+    mmm::this_ctx::yield();
+    ++count;
+}
+
+int test_main(int, char **)
+{
+    scheduler s(2, mmm::noasyncpool);
+
+    // No such CPU.
+    std::vector<std::size_t> cpus(1, static_cast<std::size_t>(-2));
+    BOOST_REQUIRE(!s.place_kernels(mmm::placement_policy(cpus)));
+
+#if defined(__linux__)
+    BOOST_REQUIRE(s.place_kernels());
+#else
+    s.place_kernels();
+#endif
+    // Added ones are placed too.
+    s.add_kernels(2);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add_thread(leaf);
+    }
+    s.join_all();
+
+    BOOST_REQUIRE(s.kernel_size() == 4);
+    BOOST_REQUIRE(count == 1000);
+    return 0;
+}
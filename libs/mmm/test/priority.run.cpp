@@ -0,0 +1,109 @@
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/priority.hpp>
+#include <boost/mmm/sleep.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::priority<> > scheduler_type;
+
+boost::mutex mtx;
+std::vector<int> finished;
+std::vector<int> woken;
+
+void work(int p)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+    boost::lock_guard<boost::mutex> guard(mtx);
+    finished.push_back(p);
+}
+
+void raise_self()
+{
+    mmm::this_ctx::yield();
+    mmm::this_ctx::set_priority(7);
+    BOOST_REQUIRE(mmm::this_ctx::get_priority() == 7);
+    work(7);
+}
+
+void spawner(scheduler_type *sp)
+{
+    scheduler_type &s = *sp;
+    // Not resumed until this one completes, since there is one kernel.
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add_thread(work, 0);
+    }
+    s.add_thread(raise_self);
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add_thread(mmm::with_priority(3), work, 3);
+    }
+    // Clamped to the highest level.
+    s.add_thread(mmm::with_priority(100), work, 7);
+}
+
+void sleeper(int p, chrono::steady_clock::time_point at)
+{
+    mmm::this_ctx::set_priority(p);
+    mmm::this_ctx::sleep_until(at);
+    boost::lock_guard<boost::mutex> guard(mtx);
+    woken.push_back(p);
+}
+
+void sleep_spawner(scheduler_type *sp)
+{
+    // Lower ones sleep first, and expire at once.
+    const chrono::steady_clock::time_point at =
+      chrono::steady_clock::now() + chrono::milliseconds(50);
+    for (int p = 0; p < 8; ++p)
+    {
+        sp->add_thread(sleeper, p, at);
+    }
+}
+
+int test_main(int, char **)
+{
+    scheduler_type s(1, mmm::noasyncpool);
+
+    s.add_thread(spawner, &s);
+    s.join_all();
+
+    BOOST_REQUIRE(finished.size() == 22);
+    // The highest one and others of priority 3 first. Raised one gets ahead
+    // of others of 0 after its first yield.
+    BOOST_REQUIRE(finished[0] == 7);
+    for (int i = 1; i < 11; ++i)
+    {
+        BOOST_REQUIRE(finished[i] == 3);
+    }
+    BOOST_REQUIRE(finished[11] == 7);
+    for (int i = 12; i < 22; ++i)
+    {
+        BOOST_REQUIRE(finished[i] == 0);
+    }
+    BOOST_REQUIRE(s.user_size() == 0);
+
+    // Woken ones are ordered by the strategy, not resumed in order of expiry
+    // via mailbox of the idle kernel.
+    s.add_thread(sleep_spawner, &s);
+    s.join_all();
+
+    BOOST_REQUIRE(woken.size() == 8);
+    for (int i = 0; i < 8; ++i)
+    {
+        BOOST_REQUIRE(woken[i] == 7 - i);
+    }
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
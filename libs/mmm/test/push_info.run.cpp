@@ -0,0 +1,126 @@
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/sleep.hpp>
+#include <boost/mmm/yield.hpp>
+#include <boost/mmm/io/posix/unistd.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+#include <unistd.h>
+#include <boost/thread/thread.hpp>
+
+boost::mutex mtx;
+std::vector<mmm::push_info> infos;
+
+struct recording {};
+
+namespace boost { namespace mmm {
+
+template <typename Context, typename Allocator>
+struct strategy_traits<recording, Context, Allocator>
+  : public strategy_traits<strategy::fifo, Context, Allocator>
+{
+    template <typename SchedulerTraits>
+    void
+    push_ctx(SchedulerTraits traits, Context ctx, const push_info &info)
+    {
+        {
+            boost::mutex::scoped_lock guard(mtx);
+            infos.push_back(info);
+        }
+        strategy_traits<strategy::fifo, Context, Allocator>().push_ctx(traits, boost::move(ctx));
+    }
+};
+
+template <typename Context, typename Allocator>
+struct accepts_push_info<strategy_traits<recording, Context, Allocator> >
+  : public mpl::true_ {};
+
+} } // namespace boost::mmm
+
+void f()
+{
+    const chrono::steady_clock::time_point end =
+      chrono::steady_clock::now() + chrono::milliseconds(2);
+    while (chrono::steady_clock::now() < end) {}
+    mmm::this_ctx::yield();
+
+    mmm::this_ctx::sleep_for(chrono::milliseconds(1));
+}
+
+template <typename Strategy>
+void check()
+{
+    infos.clear();
+    {
+        mmm::scheduler<Strategy> s(1, mmm::noasyncpool);
+        s.add_thread(f);
+        s.join_all();
+    }
+
+    // Expired one may be posted to mailbox of idle kernel instead.
+    BOOST_REQUIRE(2 <= infos.size() && infos.size() <= 3);
+
+    BOOST_REQUIRE(infos[0].reason == mmm::detail::suspension_spawned);
+    BOOST_REQUIRE(infos[0].ran == infos[0].ran.zero());
+
+    BOOST_REQUIRE(infos[1].reason == mmm::detail::suspension_yielded);
+    BOOST_REQUIRE(chrono::milliseconds(2) <= infos[1].ran);
+    BOOST_REQUIRE(infos[0].enqueued + chrono::milliseconds(2) <= infos[1].enqueued);
+
+    if (infos.size() == 3)
+    {
+        BOOST_REQUIRE(infos[2].reason == mmm::detail::suspension_timer);
+        BOOST_REQUIRE(infos[1].enqueued + chrono::milliseconds(1) <= infos[2].enqueued);
+    }
+}
+
+void reader(int fd)
+{
+    char c;
+    BOOST_REQUIRE(mmm::io::posix::read(fd, &c, 1) == 1);
+}
+
+// Without the pool, I/O is polled by the kernel each time the context is
+// popped. It is reported once when suspended, and as yielded after that.
+template <typename Strategy>
+void check_polled_io()
+{
+    infos.clear();
+    int fds[2];
+    BOOST_REQUIRE(::pipe(fds) == 0);
+    {
+        mmm::scheduler<Strategy> s(1, mmm::noasyncpool);
+        s.add_thread(reader, fds[0]);
+        boost::this_thread::sleep_for(chrono::milliseconds(10));
+        const char c = 'x';
+        BOOST_REQUIRE(::write(fds[1], &c, 1) == 1);
+        s.join_all();
+    }
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    BOOST_REQUIRE(2 <= infos.size());
+    BOOST_REQUIRE(infos[0].reason == mmm::detail::suspension_spawned);
+    BOOST_REQUIRE(infos[1].reason == mmm::detail::suspension_io);
+    for (std::size_t i = 2; i < infos.size(); ++i)
+    {
+        BOOST_REQUIRE(infos[i].reason == mmm::detail::suspension_yielded);
+        BOOST_REQUIRE(infos[i].ran == infos[i].ran.zero());
+    }
+}
+
+int test_main(int, char **)
+{
+    check<recording>();
+    check<mmm::strategy::locked<recording> >();
+    check_polled_io<recording>();
+    check_polled_io<mmm::strategy::locked<recording> >();
+    return 0;
+}
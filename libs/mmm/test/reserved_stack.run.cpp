@@ -0,0 +1,91 @@
+#define BOOST_MMM_STACK_RESERVE (8 * 1024 * 1024)
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler_type;
+
+int depth(int n)
+{
+    volatile char frame[1024];
+    frame[0] = static_cast<char>(n);
+    if (!n) { return frame[0]; }
+    return depth(n - 1) + frame[0];
+}
+
+void deep()
+{
+    // About 2MB, larger than the requested stack size.
+    depth(2 * 1024);
+}
+
+void overflow()
+{
+    for (int n = 1024; ; n *= 2) { depth(n); }
+}
+
+void idle()
+{
+    for (int i = 0; i < 4; ++i) { mmm::this_ctx::yield(); }
+}
+
+long resident_pages()
+{
+    std::ifstream ifs("/proc/self/statm");
+    long size = 0, resident = 0;
+    ifs >> size >> resident;
+    return resident;
+}
+
+int test_main(int, char **)
+{
+    // Overflow is reported and aborts, instead of corrupting others.
+    int fds[2];
+    BOOST_REQUIRE(pipe(fds) == 0);
+    const pid_t pid = fork();
+    BOOST_REQUIRE(pid != -1);
+    if (pid == 0)
+    {
+        dup2(fds[1], STDERR_FILENO);
+        scheduler_type s(1, mmm::noasyncpool);
+        s.add_thread(overflow);
+        s.join_all();
+        _exit(0);
+    }
+    close(fds[1]);
+    char buf[256] = {};
+    const ssize_t r = read(fds[0], buf, sizeof(buf) - 1);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    BOOST_REQUIRE(0 < r && std::strstr(buf, "stack overflow") != 0);
+    // Aborted, though the test runner may catch SIGABRT.
+    BOOST_REQUIRE(status != 0);
+
+    scheduler_type s(2, mmm::noasyncpool);
+
+    // Grows beyond the requested size up to the reservation.
+    s.add_thread(static_cast<scheduler_type::size_type>(64 * 1024), deep);
+    s.join_all();
+
+    // Only touched pages of reserved ones take memory.
+    const long before = resident_pages();
+    for (int i = 0; i < 1000; ++i) { s.add_thread(idle); }
+    s.join_all();
+    const long pages = (BOOST_MMM_STACK_RESERVE / sysconf(_SC_PAGESIZE)) * 1000;
+    BOOST_REQUIRE(resident_pages() - before < pages / 100);
+
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <vector>
+#include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler;
+
+// Only one kernel-thread appends.
+std::vector<int> order;
+boost::atomic<bool> ready(false);
+
+void record(int id)
+{
+    order.push_back(id);
+}
+
+void chain(scheduler *s, int n)
+{
+    record(n);
+    if (n) { s->add_thread(chain, s, n - 1); }
+    mmm::this_ctx::yield();
+}
+
+void producer(scheduler *s)
+{
+    while (!ready)
+    {
+        mmm::this_ctx::yield();
+    }
+    record(1000);
+    s->add_thread(record, 1001);
+    mmm::this_ctx::yield();
+
+    // 2000 is displaced from run-next slot by the chain.
+    s->add_thread(record, 2000);
+    s->add_thread(chain, s, 100);
+}
+
+int test_main(int, char **)
+{
+    scheduler s(1, mmm::noasyncpool);
+
+    s.add_thread(producer, &s);
+    s.add_thread(record, 3000);
+    ready = true;
+    s.join_all();
+
+    BOOST_REQUIRE(order.size() == 4 + 101);
+    std::vector<int>::iterator itr = std::find(order.begin(), order.end(), 1000);
+    // Spawned one is resumed before others queued earlier.
+    BOOST_REQUIRE(*++itr == 1001);
+
+    // Long chain of handoffs does not starve others.
+    BOOST_REQUIRE(
+      std::find(order.begin(), order.end(), 2000)
+    < std::find(order.begin(), order.end(), 0));
+    return 0;
+}
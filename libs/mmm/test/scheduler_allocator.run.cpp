@@ -0,0 +1,75 @@
+#include <cstddef>
+#include <memory>
+
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/mmm/detail/stack_utils.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+namespace mmm = boost::mmm;
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/test/minimal.hpp>
+
+boost::atomic<long> live(0);
+boost::atomic<long> stacks(0);
+
+template <typename T>
+struct counting_allocator : public std::allocator<T>
+{
+    template <typename U>
+    struct rebind
+    {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() {}
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U> &) {}
+
+    T *
+    allocate(std::size_t n, const void * = 0)
+    {
+        ++live;
+        if (ctx::minimum_stacksize() <= n * sizeof(T)) { ++stacks; }
+        return std::allocator<T>::allocate(n);
+    }
+
+    void
+    deallocate(T *p, std::size_t n)
+    {
+        --live;
+        std::allocator<T>::deallocate(p, n);
+    }
+}; // template struct counting_allocator
+
+typedef mmm::scheduler<mmm::strategy::fifo, counting_allocator<void> > scheduler_type;
+
+int twice(int v) { return v * 2; }
+
+int test_main(int, char **)
+{
+    {
+        scheduler_type s(2, mmm::noasyncpool);
+        BOOST_REQUIRE(0 < live);
+
+        BOOST_REQUIRE(s.add_thread(twice, 21).get() == 42);
+        mmm::future_group<int, counting_allocator<void> > fs = s.add_threads(8, boost::bind(twice, 1));
+        s.join_all();
+        BOOST_REQUIRE(fs.size() == 8);
+
+        // Stacks are taken from the allocator instead of being mapped.
+        BOOST_REQUIRE(0 < stacks);
+    }
+    // Everything including cached stacks is returned.
+    BOOST_REQUIRE(live == 0);
+
+    {
+        scheduler_type s(1, boost::chrono::milliseconds(10));
+        BOOST_REQUIRE(s.add_thread(twice, 1).get() == 2);
+        s.join_all();
+    }
+    BOOST_REQUIRE(live == 0);
+    return 0;
+}
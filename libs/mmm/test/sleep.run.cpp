@@ -0,0 +1,88 @@
+#include <boost/atomic.hpp>
+#include <boost/chrono/system_clocks.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/sleep.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef chrono::steady_clock::time_point time_point;
+
+boost::atomic<int> early(0);
+boost::atomic<int> order(0);
+boost::atomic<int> misordered(0);
+
+void sleeper(chrono::milliseconds d)
+{
+    const time_point deadline = chrono::steady_clock::now() + d;
+    mmm::this_ctx::sleep_for(d);
+    if (chrono::steady_clock::now() < deadline) { ++early; }
+}
+
+void ordered(time_point base, int n)
+{
+    mmm::this_ctx::sleep_until(base + chrono::milliseconds(20 * n));
+    if (order++ != n) { ++misordered; }
+}
+
+void busy()
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        mmm::this_ctx::yield();
+    }
+}
+
+template <typename Strategy>
+void run()
+{
+    early = 0;
+    order = 0;
+    misordered = 0;
+
+    {
+        // Sleeping contexts should not occupy the kernel-thread.
+        mmm::scheduler<Strategy> s(1, mmm::noasyncpool);
+
+        const time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < 100; ++i)
+        {
+            s.add_thread(sleeper, chrono::milliseconds(100));
+            s.add_thread(busy);
+        }
+        s.join_all();
+
+        BOOST_REQUIRE(chrono::steady_clock::now() - start < chrono::seconds(5));
+        BOOST_REQUIRE(early == 0);
+        BOOST_REQUIRE(s.user_size() == 0);
+    }
+
+    {
+        mmm::scheduler<Strategy> s(2, mmm::noasyncpool);
+
+        const time_point base = chrono::steady_clock::now();
+        for (int i = 4; 0 <= i; --i)
+        {
+            s.add_thread(ordered, base, i);
+        }
+        s.join_all();
+
+        BOOST_REQUIRE(order == 5);
+        BOOST_REQUIRE(misordered == 0);
+    }
+
+    // Not controlled under scheduler, just blocks.
+    const time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(10);
+    mmm::this_ctx::sleep_until(deadline);
+    BOOST_REQUIRE(deadline <= chrono::steady_clock::now());
+}
+
+int test_main(int, char **)
+{
+    run<mmm::strategy::fifo>();
+    run<mmm::strategy::work_stealing<> >();
+    return 0;
+}
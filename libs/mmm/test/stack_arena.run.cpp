@@ -0,0 +1,66 @@
+#define BOOST_MMM_STACK_ARENA 1
+#define BOOST_MMM_STACK_ARENA_CHUNK (4 * 1024 * 1024)
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/mmm/detail/stack_utils.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler_type;
+
+const int n = 256;
+std::vector<char *> frames(n);
+boost::atomic<int> started(0);
+
+void f(int i)
+{
+    char buf[1024];
+    buf[0] = static_cast<char>(i);
+    frames[i] = buf;
+
+    // Keep all of them alive, so that each has own stack.
+    ++started;
+    while (started < n) { mmm::this_ctx::yield(); }
+}
+
+void large()
+{
+    char buf[1024 * 1024];
+    buf[sizeof(buf) - 1] = 0;
+    buf[0] = buf[sizeof(buf) - 1];
+}
+
+int test_main(int, char **)
+{
+    const std::size_t size = ctx::default_stacksize();
+    scheduler_type s(1, mmm::noasyncpool);
+
+    for (int i = 0; i < n; ++i) { s.add_thread(size, f, i); }
+    s.join_all();
+
+    // Carved out of chunks next to each other, across several chunks.
+    int adjacent = 0;
+    for (int i = 1; i < n; ++i)
+    {
+        if (frames[i] - frames[i - 1] == static_cast<std::ptrdiff_t>(size)) { ++adjacent; }
+    }
+    BOOST_REQUIRE(n / 2 < adjacent);
+
+    // Freed slots are reused.
+    s.add_thread(size, f, 0);
+    s.join_all();
+
+    // Larger than a chunk.
+    s.add_thread(static_cast<std::size_t>(8 * 1024 * 1024), large);
+    s.join_all();
+
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <cstring>
+
+#include <boost/cstdint.hpp>
+
+#include <boost/mmm/detail/stack_utils.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+namespace mmm = boost::mmm;
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler_type;
+
+// Address of the frame of last touch, recorded as an integer so that it
+// does not dangle.
+boost::uintptr_t frame = 0;
+// Read back from buf, not to be optimized out.
+volatile char sink;
+
+void touch(std::size_t n)
+{
+    // Write over pages which may have been released.
+    char buf[16 * 1024];
+    std::memset(buf, 1, n < sizeof(buf) ? n : sizeof(buf));
+    sink = buf[0];
+    frame = reinterpret_cast<boost::uintptr_t>(buf);
+}
+
+boost::uintptr_t spawn(scheduler_type &s, std::size_t size)
+{
+    s.add_thread(size, touch, size / 2).get();
+    s.join_all();
+    return frame;
+}
+
+int test_main(int, char **)
+{
+    const std::size_t size = ctx::default_stacksize();
+    scheduler_type s(1, mmm::noasyncpool);
+
+    // A stack of completed context is reused by next one.
+    const boost::uintptr_t first = spawn(s, size);
+    BOOST_REQUIRE(spawn(s, size) == first);
+
+    // Still usable after its pages are released.
+    s.trim_stack_cache();
+    BOOST_REQUIRE(spawn(s, size) == first);
+
+    s.set_stack_cache(4, 0);
+    BOOST_REQUIRE(spawn(s, size) == first);
+
+    // Stacks larger than any of size classes are not cached, but work.
+    spawn(s, ctx::maximum_stacksize());
+
+    s.set_stack_cache(0, 0);
+    for (int i = 0; i < 16; ++i) { spawn(s, size); }
+
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <boost/mmm/detail/stack_utils.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy.hpp>
+#include <boost/mmm/stack_profile.hpp>
+namespace mmm = boost::mmm;
+namespace ctx = boost::mmm::detail::ctx;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::fifo> scheduler_type;
+
+const std::size_t depth = 4096;
+
+// Read back from buf, not to be optimized out.
+volatile char sink;
+
+void use_stack(int i)
+{
+    volatile char buf[depth];
+    for (std::size_t j = 0; j < depth; ++j) { buf[j] = static_cast<char>(i); }
+    sink = buf[depth - 1];
+}
+
+void shallow() {}
+
+struct functor
+{
+    void operator()() const { use_stack(0); }
+};
+
+int test_main(int, char **)
+{
+    scheduler_type s(1, mmm::noasyncpool);
+
+    // Not recorded unless profiling.
+    s.add_thread(use_stack, 0);
+    s.join_all();
+    BOOST_REQUIRE(s.get_stack_profile(use_stack).samples == 0);
+
+    mmm::stack_sizing_policy policy;
+    policy.min_samples = 4;
+    s.enable_stack_profiling(policy);
+
+    for (int i = 0; i < 4; ++i) { s.add_thread(use_stack, i); }
+    s.join_all();
+    for (int i = 0; i < 4; ++i) { s.add_thread(functor()); }
+    s.add_thread(shallow);
+    s.join_all();
+
+    const mmm::stack_profile p = s.get_stack_profile(use_stack);
+    BOOST_REQUIRE(p.samples == 4);
+    BOOST_REQUIRE(depth <= p.mean_used && p.mean_used <= p.max_used);
+    BOOST_REQUIRE(p.max_used < ctx::default_stacksize() / 2);
+    // Sized from the deepest one plus headroom.
+    BOOST_REQUIRE(p.max_used < p.stack_size);
+    BOOST_REQUIRE(p.stack_size < ctx::default_stacksize());
+    BOOST_REQUIRE(p.stack_size % ctx::pagesize() == 0);
+
+    // Function objects are recorded separately.
+    BOOST_REQUIRE(s.get_stack_profile(functor()).samples == 4);
+    BOOST_REQUIRE(s.get_stack_profile(shallow).samples == 1);
+    BOOST_REQUIRE(s.get_stack_profile(shallow).max_used < depth);
+    BOOST_REQUIRE(s.get_stack_profile(shallow).stack_size == ctx::default_stacksize());
+
+    // Sized stacks are profiled as well.
+    for (int i = 0; i < 4; ++i) { s.add_thread(use_stack, i); }
+    s.join_all();
+    BOOST_REQUIRE(s.get_stack_profile(use_stack).samples == 8);
+    BOOST_REQUIRE(s.get_stack_profile(use_stack).stack_size == p.stack_size);
+
+    // Records are kept, but no longer taken.
+    s.disable_stack_profiling();
+    s.add_thread(use_stack, 0);
+    s.join_all();
+    BOOST_REQUIRE(s.get_stack_profile(use_stack).samples == 8);
+
+    BOOST_REQUIRE(s.user_size() == 0);
+    return 0;
+}
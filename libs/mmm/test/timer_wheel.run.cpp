@@ -0,0 +1,70 @@
+#include <memory>
+#include <boost/chrono/chrono.hpp>
+#include <boost/mmm/detail/context.hpp>
+#include <boost/mmm/detail/timer_wheel.hpp>
+namespace mmm = boost::mmm;
+namespace chrono = boost::chrono;
+
+#include <boost/test/minimal.hpp>
+
+typedef
+  mmm::detail::timer_wheel<mmm::detail::context_tuple, std::allocator<void> >
+timers_type;
+typedef timers_type::time_point time_point;
+
+const int n = 64;
+
+int count_expired(timers_type &timers, const time_point &now)
+{
+    timers_type::expired_list expired;
+    timers.expire(now, expired);
+    int count = 0;
+    while (expired.pop_hook()) { ++count; }
+    return count;
+}
+
+int test_main(int, char **)
+{
+    timers_type timers(chrono::milliseconds(1), 16);
+    mmm::detail::context_hook hooks[n];
+
+    // Spread over several revolutions, so that slots are shared.
+    const time_point base = timers_type::clock_type::now();
+    for (int i = 0; i < n; ++i)
+    {
+        timers.insert_hook(&hooks[i], base + chrono::milliseconds(i + 1));
+    }
+    BOOST_REQUIRE(timers.size() == static_cast<std::size_t>(n));
+
+    // Cancel odd ones, from heads, middles and tails of slots.
+    for (int i = 1; i < n; i += 2)
+    {
+        BOOST_REQUIRE(timers.cancel(&hooks[i]));
+        BOOST_REQUIRE(!timers.cancel(&hooks[i]));
+    }
+    BOOST_REQUIRE(timers.size() == static_cast<std::size_t>(n / 2));
+
+    time_point tp;
+    BOOST_REQUIRE(timers.next_expiry(tp));
+    BOOST_REQUIRE(base < tp);
+
+    // Cancelled ones never expire.
+    BOOST_REQUIRE(count_expired(timers, base + chrono::milliseconds(n + 2)) == n / 2);
+    BOOST_REQUIRE(timers.size() == 0);
+    BOOST_REQUIRE(!timers.next_expiry(tp));
+
+    // Expired ones cannot be cancelled, and hooks can be inserted again. The
+    // wheel has advanced already, so expire after that.
+    for (int i = 0; i < n; i += 2)
+    {
+        BOOST_REQUIRE(!timers.cancel(&hooks[i]));
+    }
+    const time_point later = timers_type::clock_type::now();
+    timers.insert_hook(&hooks[0], later + chrono::milliseconds(5));
+    timers.insert_hook(&hooks[1], later + chrono::milliseconds(5));
+    BOOST_REQUIRE(timers.cancel(&hooks[0]));
+    BOOST_REQUIRE(count_expired(timers, later + chrono::milliseconds(n + 10)) == 1);
+    BOOST_REQUIRE(timers.size() == 0);
+
+    return 0;
+}
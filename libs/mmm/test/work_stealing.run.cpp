@@ -0,0 +1,45 @@
+#include <boost/atomic.hpp>
+#include <boost/mmm/scheduler.hpp>
+#include <boost/mmm/strategy/work_stealing.hpp>
+#include <boost/mmm/yield.hpp>
+namespace mmm = boost::mmm;
+
+#include <boost/test/minimal.hpp>
+
+typedef mmm::scheduler<mmm::strategy::work_stealing<> > scheduler;
+
+boost::atomic<int> count(0);
+
+void leaf()
+{
+    mmm::this_ctx::yield();
+    ++count;
+}
+
+void spawner(scheduler *s, int n)
+{
+    // Spawned from a kernel-thread, so goes to its local deque.
+    for (int i = 0; i < n; ++i)
+    {
+        s->add_thread(leaf);
+        mmm::this_ctx::yield();
+    }
+    ++count;
+}
+
+int test_main(int, char **)
+{
+    scheduler s(4, mmm::noasyncpool);
+    BOOST_REQUIRE(s.kernel_size() == 4);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        s.add_thread(spawner, &s, 100);
+    }
+    s.join_all();
+
+    BOOST_REQUIRE(!s.joinable());
+    BOOST_REQUIRE(s.user_size() == 0);
+    BOOST_REQUIRE(count == 8 + 8 * 100);
+    return 0;
+}